@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include <zephyr/bluetooth/conn.h>
+
+/* Tiers of the default Kconfig ladder. With a zmk,sdc-subrating-tiers
+ * devicetree node there are zmk_sdc_subrating_tier_count() tiers in node
+ * order, the first one entered on key presses.
+ */
+enum zmk_sdc_subrate_tier {
+    ZMK_SDC_SUBRATE_TIER_ACTIVE,
+    ZMK_SDC_SUBRATE_TIER_IDLE,
+    ZMK_SDC_SUBRATE_TIER_DORMANT,
+};
+
+/* Subrating state of one split link, as seen by the central */
+struct zmk_sdc_subrate_link_info {
+    /* Index of the tier the link is in */
+    uint8_t tier;
+    /* Parameters of the last request sent */
+    uint16_t requested_min;
+    uint16_t requested_max;
+    uint16_t requested_cn;
+    /* Parameters in effect, from the last successful subrate change;
+     * factor is 0 until one was reported
+     */
+    uint16_t factor;
+    uint16_t continuation_number;
+    uint16_t peripheral_latency;
+    uint16_t supervision_timeout;
+    /* The effective factor is outside the requested range */
+    bool diverged;
+    /* The peer does not support subrating */
+    bool unsupported;
+    /* Retries of the current request */
+    uint8_t retries;
+};
+
+/**
+ * Get the subrating state of a split link.
+ *
+ * @param slot ZMK split peripheral slot.
+ * @param info Filled in on success.
+ *
+ * @retval 0 Success.
+ * @retval -ENOTCONN No link in the slot.
+ */
+int zmk_sdc_subrating_link_info_get(uint8_t slot, struct zmk_sdc_subrate_link_info *info);
+
+/**
+ * Get the number of subrating tiers.
+ */
+uint8_t zmk_sdc_subrating_tier_count(void);
+
+/**
+ * Get the base parameters of a subrating tier, either the Kconfig or
+ * devicetree defaults or the values set at runtime. With adaptive
+ * subrating the first tier's factor and continuation number are tuned
+ * from these.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL Unknown tier.
+ */
+int zmk_sdc_subrating_tier_get(uint8_t tier, struct bt_conn_le_subrate_param *params);
+
+/**
+ * Replace the parameters of a subrating tier. They are checked against the
+ * same rules as the Kconfig values here; applying them to links in the tier
+ * and persisting them through settings happens on the system work queue.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL Unknown tier, or subrate_max * (max_latency + 1) > 500,
+ *         continuation_number >= subrate_max, or supervision_timeout
+ *         outside 10-3200 or not above 3 * subrate_max * (max_latency + 1) / 2.
+ */
+int zmk_sdc_subrating_tier_set(uint8_t tier, const struct bt_conn_le_subrate_param *params);
+
+/**
+ * Return a subrating tier to its Kconfig or devicetree parameters and drop the stored
+ * values. Like zmk_sdc_subrating_tier_set(), this is applied on the system work queue.
+ *
+ * @retval 0 Success.
+ * @retval -EINVAL Unknown tier.
+ */
+int zmk_sdc_subrating_tier_reset(uint8_t tier);
@@ -3,10 +3,21 @@
  *
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
+#include <string.h>
 #include <nrfx_clock.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
 
 #include <mpsl.h>
 #include <mpsl_clock.h>
+#include <mpsl/mpsl_hfclk.h>
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+#include "../mpsl/mpsl_hfclk_latency.h"
+#endif
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION)
+#include <zephyr/init.h>
+#include <mpsl/mpsl_radio_notif.h>
+#endif
 
 /* Include the wrapper that aliases nrfx_clock_irq_handler to nrfx_power_clock_irq_handler */
 #include "nrfx_power_clock.h"
@@ -16,6 +27,133 @@ LOG_MODULE_REGISTER(nrfx_clock_mpsl, CONFIG_CLOCK_CONTROL_LOG_LEVEL);
 
 static nrfx_clock_event_handler_t event_handler;
 
+/* Requester name used for requests from the Zephyr clock control driver */
+#define CLOCK_CONTROL_REQUESTER "clock_control"
+
+enum {
+	HFCLK_STARTED,
+	/* The clock control driver waits for NRFX_CLOCK_EVT_HFCLK_STARTED */
+	HFCLK_DRIVER_PENDING,
+};
+
+static struct k_spinlock hfclk_lock;
+static uint32_t hfclk_refcount;
+/* MPSL is asked for the crystal; follows hfclk_refcount through hfclk_sync() */
+static bool hfclk_mpsl_on;
+/* A context is running hfclk_sync() */
+static bool hfclk_syncing;
+/* Also used from the MPSL callback, which does not take hfclk_lock */
+static atomic_t hfclk_flags;
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+/* The measurement requester asked while the count was 0 */
+static bool hfclk_measure;
+/* Request time of a measured start from off, 0 when not measuring */
+static uint32_t hfclk_request_cycles;
+#endif
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_ACCOUNTING)
+static struct mpsl_hfclk_requester_stats requesters[CONFIG_MPSL_HFCLK_ACCOUNTING_REQUESTERS];
+static int64_t hfclk_on_since_ms;
+static uint64_t hfclk_on_time_ms;
+static int64_t stats_since_ms;
+
+#if CONFIG_MPSL_HFCLK_HOLD_WARN_MS > 0
+static void hold_timer_expiry(struct k_timer *timer);
+static K_TIMER_DEFINE(hold_timer, hold_timer_expiry, NULL);
+
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION)
+#define HOLD_WARN_RADIO_GATED 1
+/* A radio event was announced while the HFXO was held */
+static bool hold_radio_seen;
+
+static void hold_radio_active_soon(void)
+{
+	hold_radio_seen = true;
+}
+
+static struct mpsl_radio_notif_listener hold_listener = {
+	.active_soon = hold_radio_active_soon,
+};
+#endif /* CONFIG_MPSL_RADIO_NOTIFICATION */
+
+/* One-shot per hold, armed by the request that turns the HFXO on. */
+static void hold_timer_expiry(struct k_timer *timer)
+{
+	int64_t now = k_uptime_get();
+
+	ARG_UNUSED(timer);
+
+#if defined(HOLD_WARN_RADIO_GATED)
+	/* The radio runs the crystal for its own events anyway, so a hold
+	 * only costs current while no radio activity is scheduled.
+	 */
+	if (hold_radio_seen || !mpsl_radio_notif_is_idle()) {
+		return;
+	}
+#endif
+
+	K_SPINLOCK(&hfclk_lock) {
+		LOG_WRN("HFXO held for %lld ms without radio use", now - hfclk_on_since_ms);
+
+		for (size_t i = 0; i < ARRAY_SIZE(requesters) && requesters[i].name; i++) {
+			if (requesters[i].refcount) {
+				LOG_WRN("  %s: %u request(s) since %lld ms", requesters[i].name,
+					requesters[i].refcount, requesters[i].last_request_ms);
+			}
+		}
+	}
+}
+#endif /* CONFIG_MPSL_HFCLK_HOLD_WARN_MS > 0 */
+
+static struct mpsl_hfclk_requester_stats *requester_get(const char *name)
+{
+	for (size_t i = 0; i < ARRAY_SIZE(requesters); i++) {
+		if (requesters[i].name == name) {
+			return &requesters[i];
+		} else if (requesters[i].name == NULL) {
+			requesters[i].name = name;
+			return &requesters[i];
+		}
+	}
+
+	/* Table full: still reference counted, just not accounted */
+	return NULL;
+}
+
+static void requester_account(const char *name, bool request, int64_t now)
+{
+	struct mpsl_hfclk_requester_stats *req = requester_get(name);
+
+	if (req == NULL) {
+		return;
+	}
+
+	if (request) {
+		req->requests++;
+		if (req->refcount++ == 0) {
+			req->last_request_ms = now;
+		}
+	} else if (req->refcount > 0 && --req->refcount == 0) {
+		req->last_release_ms = now;
+		req->on_time_ms += now - MAX(req->last_request_ms, stats_since_ms);
+	}
+}
+#endif /* CONFIG_MPSL_HFCLK_ACCOUNTING */
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_RADIO_ALIGN)
+static struct k_spinlock aligned_lock;
+/* Waiting for a radio event or the deadline */
+static sys_slist_t aligned_pending = SYS_SLIST_STATIC_INIT(&aligned_pending);
+/* Requested, waiting for HFCLK_STARTED */
+static sys_slist_t aligned_starting = SYS_SLIST_STATIC_INIT(&aligned_starting);
+static uint32_t aligned_radio_count;
+static uint32_t aligned_deadline_count;
+static uint32_t aligned_running_count;
+
+static void aligned_flush(void);
+#endif /* CONFIG_MPSL_HFCLK_RADIO_ALIGN */
+
 static void mpsl_hfclk_src_callback(mpsl_clock_evt_type_t evt_type)
 {
 	switch (evt_type) {
@@ -28,7 +166,20 @@ static void mpsl_hfclk_src_callback(mpsl_clock_evt_type_t evt_type)
 		break;
 #endif /* NRF_CLOCK_HAS_XO_TUNE */
 	case MPSL_CLOCK_EVT_HFCLK_STARTED:
-		event_handler(NRFX_CLOCK_EVT_HFCLK_STARTED);
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+		if (hfclk_request_cycles) {
+			mpsl_hfclk_latency_sample(
+				k_cyc_to_us_ceil32(k_cycle_get_32() - hfclk_request_cycles));
+			hfclk_request_cycles = 0;
+		}
+#endif
+		atomic_set_bit(&hfclk_flags, HFCLK_STARTED);
+		if (atomic_test_and_clear_bit(&hfclk_flags, HFCLK_DRIVER_PENDING)) {
+			event_handler(NRFX_CLOCK_EVT_HFCLK_STARTED);
+		}
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_RADIO_ALIGN)
+		aligned_flush();
+#endif
 		break;
 #if NRF_CLOCK_HAS_HFCLK24M
 	case MPSL_CLOCK_EVT_HFCLK24M_STARTED:
@@ -41,11 +192,424 @@ static void mpsl_hfclk_src_callback(mpsl_clock_evt_type_t evt_type)
 	}
 }
 
+/* Called with hfclk_lock held after hfclk_refcount changed. Returns true
+ * if the caller has to run hfclk_sync() once it dropped the lock.
+ */
+static bool hfclk_sync_claim(void)
+{
+	if (hfclk_syncing || (hfclk_refcount > 0) == hfclk_mpsl_on) {
+		return false;
+	}
+
+	hfclk_syncing = true;
+
+	return true;
+}
+
+/* Bring the MPSL request in line with hfclk_refcount. MPSL is called
+ * without hfclk_lock, as it may report HFCLK_STARTED synchronously and the
+ * callbacks request and release again. Only one context syncs at a time and
+ * it loops until changes made meanwhile by others are applied too, so the
+ * MPSL request and release calls cannot be reordered.
+ */
+static void hfclk_sync(void)
+{
+	for (;;) {
+		bool on = false;
+		bool done = false;
+
+		K_SPINLOCK(&hfclk_lock) {
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+			bool measure = hfclk_measure;
+
+			hfclk_measure = false;
+#endif
+			on = (hfclk_refcount > 0);
+			if (on == hfclk_mpsl_on) {
+				hfclk_syncing = false;
+				done = true;
+				K_SPINLOCK_BREAK;
+			}
+
+			hfclk_mpsl_on = on;
+			if (!on) {
+				atomic_clear(&hfclk_flags);
+			}
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+			/* Only a start from off says anything about the crystal.
+			 * Other requesters may start it from a context that is
+			 * itself delayed, so only the measurement requests count.
+			 */
+			hfclk_request_cycles =
+				(on && measure &&
+				 !nrf_clock_hf_is_running(NRF_CLOCK,
+							  NRF_CLOCK_HFCLK_HIGH_ACCURACY))
+					? MAX(k_cycle_get_32(), 1) : 0;
+#endif
+		}
+
+		if (done) {
+			return;
+		}
+
+		if (on) {
+			/* May report HFCLK_STARTED right away if the radio
+			 * already runs the crystal.
+			 */
+			mpsl_clock_hfclk_src_request(MPSL_CLOCK_HF_SRC_XO, mpsl_hfclk_src_callback);
+		} else {
+			mpsl_clock_hfclk_src_release(MPSL_CLOCK_HF_SRC_XO);
+		}
+	}
+}
+
+static bool hfclk_request(const char *requester, bool from_driver)
+{
+	bool running = false;
+	bool sync = false;
+
+	K_SPINLOCK(&hfclk_lock) {
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_ACCOUNTING)
+		int64_t now = k_uptime_get();
+
+		requester_account(requester, true, now);
+		if (hfclk_refcount == 0) {
+			hfclk_on_since_ms = now;
+#if CONFIG_MPSL_HFCLK_HOLD_WARN_MS > 0
+#if defined(HOLD_WARN_RADIO_GATED)
+			hold_radio_seen = false;
+#endif
+			k_timer_start(&hold_timer, K_MSEC(CONFIG_MPSL_HFCLK_HOLD_WARN_MS),
+				      K_NO_WAIT);
+#endif
+		}
+#else
+		ARG_UNUSED(requester);
+#endif
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+		if (hfclk_refcount == 0 && requester == mpsl_hfclk_latency_requester) {
+			hfclk_measure = true;
+		}
+#endif
+		hfclk_refcount++;
+		sync = hfclk_sync_claim();
+
+		running = atomic_test_bit(&hfclk_flags, HFCLK_STARTED);
+		if (from_driver && !running) {
+			atomic_set_bit(&hfclk_flags, HFCLK_DRIVER_PENDING);
+		}
+	}
+
+	if (sync) {
+		hfclk_sync();
+	}
+
+	return running;
+}
+
+static void hfclk_release(const char *requester)
+{
+	bool sync = false;
+
+	K_SPINLOCK(&hfclk_lock) {
+		if (hfclk_refcount == 0) {
+			__ASSERT(false, "Unbalanced HFCLK release");
+			K_SPINLOCK_BREAK;
+		}
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_ACCOUNTING)
+		int64_t now = k_uptime_get();
+
+		requester_account(requester, false, now);
+		if (hfclk_refcount == 1) {
+			hfclk_on_time_ms += now - MAX(hfclk_on_since_ms, stats_since_ms);
+#if CONFIG_MPSL_HFCLK_HOLD_WARN_MS > 0
+			k_timer_stop(&hold_timer);
+#endif
+		}
+#else
+		ARG_UNUSED(requester);
+#endif
+
+		hfclk_refcount--;
+		sync = hfclk_sync_claim();
+	}
+
+	if (sync) {
+		hfclk_sync();
+	}
+}
+
+void mpsl_hfclk_request(const char *requester)
+{
+	(void)hfclk_request(requester, false);
+}
+
+void mpsl_hfclk_release(const char *requester)
+{
+	hfclk_release(requester);
+}
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_RADIO_ALIGN)
+/* Report HFCLK_STARTED to the aligned requests that wait for it. */
+static void aligned_flush(void)
+{
+	sys_slist_t started;
+	struct mpsl_hfclk_aligned_req *req, *tmp;
+
+	K_SPINLOCK(&aligned_lock) {
+		started = aligned_starting;
+		sys_slist_init(&aligned_starting);
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&started, req, tmp, node) {
+		req->started(req);
+	}
+}
+
+/* Called with aligned_lock held. */
+static bool aligned_queued(struct mpsl_hfclk_aligned_req *req)
+{
+	sys_snode_t *prev;
+
+	return sys_slist_find(&aligned_pending, &req->node, &prev) ||
+	       sys_slist_find(&aligned_starting, &req->node, &prev);
+}
+
+/* Request the HFXO for a request already on aligned_starting. */
+static void aligned_hfclk_request(struct mpsl_hfclk_aligned_req *req)
+{
+	mpsl_hfclk_request(req->requester);
+
+	/* No HFCLK_STARTED event follows if the crystal was already running */
+	if (atomic_test_bit(&hfclk_flags, HFCLK_STARTED)) {
+		aligned_flush();
+	}
+}
+
+static void aligned_start(struct mpsl_hfclk_aligned_req *req)
+{
+	K_SPINLOCK(&aligned_lock) {
+		sys_slist_append(&aligned_starting, &req->node);
+	}
+
+	aligned_hfclk_request(req);
+}
+
+static void aligned_deadline_expiry(struct k_timer *timer)
+{
+	struct mpsl_hfclk_aligned_req *req =
+		CONTAINER_OF(timer, struct mpsl_hfclk_aligned_req, deadline);
+	bool found = false;
+
+	K_SPINLOCK(&aligned_lock) {
+		found = sys_slist_find_and_remove(&aligned_pending, &req->node);
+		aligned_deadline_count += found ? 1 : 0;
+	}
+
+	if (found) {
+		aligned_start(req);
+	}
+}
+
+static void aligned_radio_active_soon(void)
+{
+	sys_slist_t ready;
+	struct mpsl_hfclk_aligned_req *req, *tmp;
+
+	K_SPINLOCK(&aligned_lock) {
+		ready = aligned_pending;
+		sys_slist_init(&aligned_pending);
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&ready, req, tmp, node) {
+		k_timer_stop(&req->deadline);
+		K_SPINLOCK(&aligned_lock) {
+			aligned_radio_count++;
+		}
+		aligned_start(req);
+	}
+}
+
+static struct mpsl_radio_notif_listener aligned_listener = {
+	.active_soon = aligned_radio_active_soon,
+};
+
+int mpsl_hfclk_request_aligned(struct mpsl_hfclk_aligned_req *req, k_timeout_t max_delay)
+{
+	bool now = atomic_test_bit(&hfclk_flags, HFCLK_STARTED) ||
+		   K_TIMEOUT_EQ(max_delay, K_NO_WAIT);
+	int err = 0;
+
+	__ASSERT_NO_MSG(req->started != NULL);
+
+	K_SPINLOCK(&aligned_lock) {
+		if (aligned_queued(req)) {
+			/* Queued twice the node would corrupt the list, and
+			 * the deadline timer may still be running.
+			 */
+			err = -EBUSY;
+			K_SPINLOCK_BREAK;
+		}
+
+		if (now) {
+			aligned_running_count++;
+			sys_slist_append(&aligned_starting, &req->node);
+		}
+	}
+
+	if (err) {
+		return err;
+	}
+
+	if (now) {
+		aligned_hfclk_request(req);
+		return 0;
+	}
+
+	/* Not on any list, so the timer is idle and can be initialized */
+	k_timer_init(&req->deadline, aligned_deadline_expiry, NULL);
+
+	K_SPINLOCK(&aligned_lock) {
+		sys_slist_append(&aligned_pending, &req->node);
+	}
+
+	k_timer_start(&req->deadline, max_delay, K_NO_WAIT);
+
+	return 0;
+}
+
+int mpsl_hfclk_request_aligned_cancel(struct mpsl_hfclk_aligned_req *req)
+{
+	bool found = false;
+
+	K_SPINLOCK(&aligned_lock) {
+		found = sys_slist_find_and_remove(&aligned_pending, &req->node);
+	}
+
+	if (!found) {
+		return -EALREADY;
+	}
+
+	k_timer_stop(&req->deadline);
+
+	return 0;
+}
+
+void mpsl_hfclk_aligned_stats_get(struct mpsl_hfclk_aligned_stats *stats)
+{
+	K_SPINLOCK(&aligned_lock) {
+		stats->radio = aligned_radio_count;
+		stats->deadline = aligned_deadline_count;
+		stats->running = aligned_running_count;
+	}
+}
+
+#endif /* CONFIG_MPSL_HFCLK_RADIO_ALIGN */
+
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION)
+static int radio_listeners_init(void)
+{
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_RADIO_ALIGN)
+	mpsl_radio_notif_listener_add(&aligned_listener);
+#endif
+#if defined(HOLD_WARN_RADIO_GATED)
+	mpsl_radio_notif_listener_add(&hold_listener);
+#endif
+
+	return 0;
+}
+
+SYS_INIT(radio_listeners_init, PRE_KERNEL_1, 0);
+#endif /* CONFIG_MPSL_RADIO_NOTIFICATION */
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_ACCOUNTING)
+size_t mpsl_hfclk_stats_get(struct mpsl_hfclk_stats *stats,
+			    struct mpsl_hfclk_requester_stats *out, size_t max, bool reset)
+{
+	size_t count = 0;
+
+	K_SPINLOCK(&hfclk_lock) {
+		int64_t now = k_uptime_get();
+
+		stats->refcount = hfclk_refcount;
+		stats->on_time_ms = hfclk_on_time_ms;
+		stats->since_ms = stats_since_ms;
+		if (hfclk_refcount) {
+			stats->on_time_ms += now - MAX(hfclk_on_since_ms, stats_since_ms);
+		}
+
+		for (size_t i = 0; i < ARRAY_SIZE(requesters) && requesters[i].name; i++) {
+			if (count < max) {
+				out[count] = requesters[i];
+				if (requesters[i].refcount) {
+					out[count].on_time_ms +=
+						now - MAX(requesters[i].last_request_ms,
+							  stats_since_ms);
+				}
+				count++;
+			}
+
+			if (reset) {
+				requesters[i].requests = 0;
+				requesters[i].on_time_ms = 0;
+			}
+		}
+
+		if (reset) {
+			hfclk_on_time_ms = 0;
+			stats_since_ms = now;
+		}
+	}
+
+	return count;
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_hfclk(const struct shell *sh, size_t argc, char **argv)
+{
+	struct mpsl_hfclk_requester_stats reqs[CONFIG_MPSL_HFCLK_ACCOUNTING_REQUESTERS];
+	struct mpsl_hfclk_stats stats;
+	bool reset = (argc > 1 && strcmp(argv[1], "reset") == 0);
+	size_t count = mpsl_hfclk_stats_get(&stats, reqs, ARRAY_SIZE(reqs), reset);
+	int64_t elapsed_ms = MAX(k_uptime_get() - stats.since_ms, 1);
+
+	shell_print(sh, "HFXO held %llu ms of %lld ms (%llu.%02llu%%), %u request(s) open",
+		    stats.on_time_ms, elapsed_ms, stats.on_time_ms * 100 / elapsed_ms,
+		    stats.on_time_ms * 10000 / elapsed_ms % 100, stats.refcount);
+	shell_print(sh, "%-16s %6s %8s %12s %14s %14s", "requester", "open", "requests",
+		    "on time", "last request", "last release");
+
+	for (size_t i = 0; i < count; i++) {
+		shell_print(sh, "%-16s %6u %8u %9llu ms %11lld ms %11lld ms", reqs[i].name,
+			    reqs[i].refcount, reqs[i].requests, reqs[i].on_time_ms,
+			    reqs[i].last_request_ms, reqs[i].last_release_ms);
+	}
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_RADIO_ALIGN)
+	struct mpsl_hfclk_aligned_stats aligned;
+
+	mpsl_hfclk_aligned_stats_get(&aligned);
+	shell_print(sh, "Aligned requests: %u with radio, %u already running, %u at deadline",
+		    aligned.radio, aligned.running, aligned.deadline);
+#endif
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((mpsl), hfclk, NULL, "Show non-radio HFXO requests and on time [reset]",
+		 cmd_hfclk, 1, 1);
+#endif /* CONFIG_SHELL */
+#endif /* CONFIG_MPSL_HFCLK_ACCOUNTING */
+
 void nrfx_clock_start(nrf_clock_domain_t domain)
 {
 	switch (domain) {
 	case NRF_CLOCK_DOMAIN_HFCLK:
-		mpsl_clock_hfclk_src_request(MPSL_CLOCK_HF_SRC_XO, mpsl_hfclk_src_callback);
+		if (hfclk_request(CLOCK_CONTROL_REQUESTER, true)) {
+			/* Already running for another requester */
+			event_handler(NRFX_CLOCK_EVT_HFCLK_STARTED);
+		}
 		break;
 #if NRF_CLOCK_HAS_HFCLK24M
 	case NRF_CLOCK_DOMAIN_HFCLK24M:
@@ -64,7 +628,7 @@ void nrfx_clock_stop(nrf_clock_domain_t domain)
 {
 	switch (domain) {
 	case NRF_CLOCK_DOMAIN_HFCLK:
-		mpsl_clock_hfclk_src_release(MPSL_CLOCK_HF_SRC_XO);
+		hfclk_release(CLOCK_CONTROL_REQUESTER);
 		break;
 #if NRF_CLOCK_HAS_HFCLK24M
 	case NRF_CLOCK_DOMAIN_HFCLK24M:
@@ -4,16 +4,22 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <string.h>
 #include <zephyr/types.h>
 #include <zephyr/sys/byteorder.h>
 #include <stddef.h>
 #include <stdint.h>
 #include <soc.h>
 #include <mpsl_ecb.h>
-#include <zephyr/drivers/entropy.h>
+#include <zephyr/init.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <zephyr/bluetooth/conn.h>
 
 #include "nrf_errno.h"
 #include "multithreading_lock.h"
+#include "entropy_pool.h"
+#include "sdc_crypto.h"
 
 #define LOG_LEVEL CONFIG_BT_HCI_DRIVER_LOG_LEVEL
 #include "zephyr/logging/log.h"
@@ -21,26 +27,179 @@ LOG_MODULE_REGISTER(bt_sdc_crypto);
 
 #define BT_ECB_BLOCK_SIZE 16
 
-static const struct device *dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_entropy));
-
 int bt_rand(void *buf, size_t len)
 {
-	if (unlikely(!device_is_ready(dev))) {
-		return -ENODEV;
+	return entropy_pool_get((uint8_t *)buf, len);
+}
+
+#if CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0
+/* Results of ah(irk, prand) = e(irk, padding || prand), the only encryption
+ * the host does per IRK when resolving an RPA. Entries are keyed by the IRK
+ * value itself and dropped when a bond is deleted, so no key material of a
+ * removed bond stays behind.
+ */
+#define RPA_PRAND_SIZE 3
+
+struct rpa_cache_entry {
+	uint8_t irk[BT_ECB_BLOCK_SIZE];
+	uint8_t prand[RPA_PRAND_SIZE];
+	uint8_t enc_data[BT_ECB_BLOCK_SIZE];
+	uint32_t last_used;
+};
+
+static struct k_spinlock rpa_cache_lock;
+static struct rpa_cache_entry rpa_cache[CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE];
+static uint32_t rpa_cache_clock;
+static struct sdc_crypto_rpa_cache_stats rpa_cache_stats;
+
+static bool plaintext_is_ah(const uint8_t plaintext[BT_ECB_BLOCK_SIZE])
+{
+	for (size_t i = RPA_PRAND_SIZE; i < BT_ECB_BLOCK_SIZE; i++) {
+		if (plaintext[i] != 0) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static bool rpa_cache_lookup(const uint8_t irk[BT_ECB_BLOCK_SIZE],
+			     const uint8_t prand[RPA_PRAND_SIZE],
+			     uint8_t enc_data[BT_ECB_BLOCK_SIZE])
+{
+	bool hit = false;
+
+	K_SPINLOCK(&rpa_cache_lock) {
+		for (size_t i = 0; i < ARRAY_SIZE(rpa_cache); i++) {
+			struct rpa_cache_entry *entry = &rpa_cache[i];
+
+			if (entry->last_used != 0 &&
+			    memcmp(entry->prand, prand, RPA_PRAND_SIZE) == 0 &&
+			    memcmp(entry->irk, irk, BT_ECB_BLOCK_SIZE) == 0) {
+				memcpy(enc_data, entry->enc_data, BT_ECB_BLOCK_SIZE);
+				entry->last_used = ++rpa_cache_clock;
+				hit = true;
+				break;
+			}
+		}
+
+		if (hit) {
+			rpa_cache_stats.hits++;
+		} else {
+			rpa_cache_stats.misses++;
+		}
+	}
+
+	return hit;
+}
+
+static void rpa_cache_store(const uint8_t irk[BT_ECB_BLOCK_SIZE],
+			    const uint8_t prand[RPA_PRAND_SIZE],
+			    const uint8_t enc_data[BT_ECB_BLOCK_SIZE])
+{
+	K_SPINLOCK(&rpa_cache_lock) {
+		struct rpa_cache_entry *lru = &rpa_cache[0];
+
+		for (size_t i = 1; i < ARRAY_SIZE(rpa_cache); i++) {
+			if (rpa_cache[i].last_used < lru->last_used) {
+				lru = &rpa_cache[i];
+			}
+		}
+
+		memcpy(lru->irk, irk, BT_ECB_BLOCK_SIZE);
+		memcpy(lru->prand, prand, RPA_PRAND_SIZE);
+		memcpy(lru->enc_data, enc_data, BT_ECB_BLOCK_SIZE);
+		lru->last_used = ++rpa_cache_clock;
+	}
+}
+
+void sdc_crypto_rpa_cache_clear(void)
+{
+	K_SPINLOCK(&rpa_cache_lock) {
+		memset(rpa_cache, 0, sizeof(rpa_cache));
+		rpa_cache_clock = 0;
+	}
+}
+
+#if defined(CONFIG_BT_SMP)
+static void rpa_cache_bond_deleted(uint8_t id, const bt_addr_le_t *peer)
+{
+	ARG_UNUSED(id);
+	ARG_UNUSED(peer);
+
+	/* Entries only know the IRK, not the peer it belonged to */
+	sdc_crypto_rpa_cache_clear();
+}
+
+static struct bt_conn_auth_info_cb rpa_cache_auth_info_cb = {
+	.bond_deleted = rpa_cache_bond_deleted,
+};
+
+static int rpa_cache_init(void)
+{
+	return bt_conn_auth_info_cb_register(&rpa_cache_auth_info_cb);
+}
+
+SYS_INIT(rpa_cache_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+#endif /* CONFIG_BT_SMP */
+
+void sdc_crypto_rpa_cache_stats_get(struct sdc_crypto_rpa_cache_stats *stats, bool reset)
+{
+	K_SPINLOCK(&rpa_cache_lock) {
+		*stats = rpa_cache_stats;
+		if (reset) {
+			memset(&rpa_cache_stats, 0, sizeof(rpa_cache_stats));
+		}
 	}
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_rpa_cache(const struct shell *sh, size_t argc, char **argv)
+{
+	struct sdc_crypto_rpa_cache_stats stats;
+	bool reset = (argc > 1 && strcmp(argv[1], "reset") == 0);
 
-	return entropy_get_entropy(dev, (uint8_t *)buf, len);
+	sdc_crypto_rpa_cache_stats_get(&stats, reset);
+
+	uint32_t total = stats.hits + stats.misses;
+
+	shell_print(sh, "RPA cache: %u hits, %u misses (%u%% hit rate)", stats.hits,
+		    stats.misses, total ? stats.hits * 100U / total : 0);
+
+	return 0;
 }
 
+SHELL_SUBCMD_ADD((mpsl), rpa_cache, NULL, "Show RPA resolution cache hit rate [reset]",
+		 cmd_rpa_cache, 1, 1);
+#endif /* CONFIG_SHELL */
+#endif /* CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0 */
+
 int bt_encrypt_le(const uint8_t key[BT_ECB_BLOCK_SIZE],
 		  const uint8_t plaintext[BT_ECB_BLOCK_SIZE],
 		  uint8_t enc_data[BT_ECB_BLOCK_SIZE])
 {
 	LOG_HEXDUMP_DBG(key, BT_ECB_BLOCK_SIZE, "key");
 	LOG_HEXDUMP_DBG(plaintext, BT_ECB_BLOCK_SIZE, "plaintext");
+#if CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0
+	bool is_ah = plaintext_is_ah(plaintext);
+	uint8_t prand[RPA_PRAND_SIZE];
+
+	if (is_ah) {
+		/* enc_data may alias plaintext */
+		memcpy(prand, plaintext, RPA_PRAND_SIZE);
+		if (rpa_cache_lookup(key, prand, enc_data)) {
+			return 0;
+		}
+	}
+#endif /* CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0 */
 	mpsl_ecb_block_encrypt_extended(key, plaintext, enc_data,
 			MPSL_ECB_INPUT_LE | MPSL_ECB_OUTPUT_LE);
 	LOG_HEXDUMP_DBG(enc_data, BT_ECB_BLOCK_SIZE, "enc_data");
+#if CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0
+	if (is_ah) {
+		rpa_cache_store(key, prand, enc_data);
+	}
+#endif /* CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0 */
 	return 0;
 }
 
@@ -54,3 +213,24 @@ int bt_encrypt_be(const uint8_t key[BT_ECB_BLOCK_SIZE],
 	LOG_HEXDUMP_DBG(enc_data, BT_ECB_BLOCK_SIZE, "enc_data");
 	return 0;
 }
+
+static void encrypt_batch(const struct sdc_crypto_ecb_block *blocks, size_t count,
+			  uint32_t flags)
+{
+	LOG_DBG("Encrypting %zu blocks", count);
+
+	for (size_t i = 0; i < count; i++) {
+		mpsl_ecb_block_encrypt_extended(blocks[i].key, blocks[i].plaintext,
+						blocks[i].enc_data, flags);
+	}
+}
+
+void sdc_crypto_encrypt_le_batch(const struct sdc_crypto_ecb_block *blocks, size_t count)
+{
+	encrypt_batch(blocks, count, MPSL_ECB_INPUT_LE | MPSL_ECB_OUTPUT_LE);
+}
+
+void sdc_crypto_encrypt_be_batch(const struct sdc_crypto_ecb_block *blocks, size_t count)
+{
+	encrypt_batch(blocks, count, MPSL_ECB_NO_FLAGS);
+}
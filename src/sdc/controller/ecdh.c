@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/sys/byteorder.h>
+#include <psa/crypto.h>
+#include <mpsl/mpsl_work.h>
+
+#include "ecdh.h"
+
+#define LOG_LEVEL CONFIG_BT_HCI_DRIVER_LOG_LEVEL
+#include "zephyr/logging/log.h"
+LOG_MODULE_REGISTER(bt_sdc_ecdh);
+
+/* Uncompressed SEC1 point: 0x04 || X || Y, big-endian */
+#define SEC1_PUBLIC_KEY_LEN (1 + BT_PUB_KEY_LEN)
+
+enum ecdh_op {
+	ECDH_OP_NONE,
+	ECDH_OP_PUBLIC_KEY,
+	ECDH_OP_DHKEY,
+	ECDH_OP_DHKEY_DEBUG,
+};
+
+/* Private debug key, Core Specification Vol 3, Part H, 2.3.5.6.1 */
+static const uint8_t debug_private_key_be[32] = {
+	0x3f, 0x49, 0xf6, 0xd4, 0xa3, 0xc5, 0x5f, 0x38, 0x74, 0xc9, 0xb3, 0xe3, 0xd2, 0x10, 0x3f, 0x50,
+	0x4a, 0xff, 0x60, 0x7b, 0xeb, 0x40, 0xb7, 0x99, 0x58, 0x99, 0xb8, 0xa6, 0xcd, 0x3c, 0x1a, 0xbd,
+};
+
+static void (*evt_signal_cb)(void);
+
+static struct k_spinlock lock;
+static enum ecdh_op pending_op;
+static uint8_t remote_pk_sec1[SEC1_PUBLIC_KEY_LEN];
+
+static bool evt_ready;
+static uint8_t evt_buf[BT_HCI_EVT_HDR_SIZE + sizeof(struct bt_hci_evt_le_meta_event) +
+		       sizeof(struct bt_hci_evt_le_p256_public_key_complete)];
+
+/* Only accessed from the housekeeping queue. */
+static psa_key_id_t local_key = PSA_KEY_ID_NULL;
+#if IS_ENABLED(CONFIG_BT_CTLR_ECDH_PRECOMPUTE_KEY)
+static psa_key_id_t spare_key = PSA_KEY_ID_NULL;
+#endif
+
+static void op_work_handler(struct k_work *work);
+static K_WORK_DEFINE(op_work, op_work_handler);
+
+#if IS_ENABLED(CONFIG_BT_CTLR_ECDH_PRECOMPUTE_KEY)
+static void precompute_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(precompute_work, precompute_work_handler);
+#endif
+
+static void key_attributes_set(psa_key_attributes_t *attr)
+{
+	psa_set_key_usage_flags(attr, PSA_KEY_USAGE_DERIVE);
+	psa_set_key_lifetime(attr, PSA_KEY_LIFETIME_VOLATILE);
+	psa_set_key_algorithm(attr, PSA_ALG_ECDH);
+	psa_set_key_type(attr, PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_SECP_R1));
+	psa_set_key_bits(attr, 256);
+}
+
+static psa_status_t key_generate(psa_key_id_t *key)
+{
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+	uint32_t start = k_cycle_get_32();
+
+	key_attributes_set(&attr);
+
+	psa_status_t status = psa_generate_key(&attr, key);
+
+	LOG_DBG("P-256 keypair generated in %u us (%d)",
+		k_cyc_to_us_floor32(k_cycle_get_32() - start), status);
+
+	return status;
+}
+
+static void key_destroy(psa_key_id_t *key)
+{
+	if (*key != PSA_KEY_ID_NULL) {
+		(void)psa_destroy_key(*key);
+		*key = PSA_KEY_ID_NULL;
+	}
+}
+
+/* Switch the SEC1 big-endian coordinates to HCI little-endian order. */
+static void sec1_to_hci(uint8_t *hci_pk, const uint8_t *sec1_pk)
+{
+	sys_memcpy_swap(&hci_pk[0], &sec1_pk[1], 32);
+	sys_memcpy_swap(&hci_pk[32], &sec1_pk[33], 32);
+}
+
+static void hci_to_sec1(uint8_t *sec1_pk, const uint8_t *hci_pk)
+{
+	sec1_pk[0] = 0x04;
+	sys_memcpy_swap(&sec1_pk[1], &hci_pk[0], 32);
+	sys_memcpy_swap(&sec1_pk[33], &hci_pk[32], 32);
+}
+
+static uint8_t public_key_get(uint8_t *hci_pk)
+{
+	uint8_t sec1_pk[SEC1_PUBLIC_KEY_LEN];
+	size_t len;
+
+	key_destroy(&local_key);
+
+#if IS_ENABLED(CONFIG_BT_CTLR_ECDH_PRECOMPUTE_KEY)
+	/* Hand out the spare keypair and make a new one once things settle. */
+	local_key = spare_key;
+	spare_key = PSA_KEY_ID_NULL;
+	k_work_cancel_delayable(&precompute_work);
+	mpsl_housekeeping_work_schedule(&precompute_work,
+					K_MSEC(CONFIG_BT_CTLR_ECDH_PRECOMPUTE_DELAY));
+#endif
+
+	if (local_key == PSA_KEY_ID_NULL && key_generate(&local_key) != PSA_SUCCESS) {
+		local_key = PSA_KEY_ID_NULL;
+		return BT_HCI_ERR_UNSPECIFIED;
+	}
+
+	if (psa_export_public_key(local_key, sec1_pk, sizeof(sec1_pk), &len) != PSA_SUCCESS ||
+	    len != sizeof(sec1_pk)) {
+		key_destroy(&local_key);
+		return BT_HCI_ERR_UNSPECIFIED;
+	}
+
+	sec1_to_hci(hci_pk, sec1_pk);
+
+	return BT_HCI_ERR_SUCCESS;
+}
+
+static uint8_t dhkey_compute(psa_key_id_t key, const uint8_t *sec1_pk, uint8_t *dhkey)
+{
+	uint8_t dhkey_be[BT_DH_KEY_LEN];
+	uint32_t start = k_cycle_get_32();
+	size_t len;
+
+	psa_status_t status = psa_raw_key_agreement(PSA_ALG_ECDH, key, sec1_pk,
+						    SEC1_PUBLIC_KEY_LEN, dhkey_be,
+						    sizeof(dhkey_be), &len);
+
+	LOG_DBG("DHKey computed in %u us (%d)",
+		k_cyc_to_us_floor32(k_cycle_get_32() - start), status);
+
+	if (status == PSA_ERROR_INVALID_ARGUMENT) {
+		/* Remote public key is not a point on the curve */
+		return BT_HCI_ERR_INVALID_PARAM;
+	} else if (status != PSA_SUCCESS || len != sizeof(dhkey_be)) {
+		return BT_HCI_ERR_UNSPECIFIED;
+	}
+
+	sys_memcpy_swap(dhkey, dhkey_be, sizeof(dhkey_be));
+	memset(dhkey_be, 0, sizeof(dhkey_be));
+
+	return BT_HCI_ERR_SUCCESS;
+}
+
+static uint8_t dhkey_get(enum ecdh_op op, const uint8_t *sec1_pk, uint8_t *dhkey)
+{
+	if (op == ECDH_OP_DHKEY) {
+		if (local_key == PSA_KEY_ID_NULL) {
+			return BT_HCI_ERR_CMD_DISALLOWED;
+		}
+
+		return dhkey_compute(local_key, sec1_pk, dhkey);
+	}
+
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+	psa_key_id_t debug_key;
+	uint8_t status;
+
+	key_attributes_set(&attr);
+
+	if (psa_import_key(&attr, debug_private_key_be, sizeof(debug_private_key_be),
+			   &debug_key) != PSA_SUCCESS) {
+		return BT_HCI_ERR_UNSPECIFIED;
+	}
+
+	status = dhkey_compute(debug_key, sec1_pk, dhkey);
+	key_destroy(&debug_key);
+
+	return status;
+}
+
+static void op_work_handler(struct k_work *work)
+{
+	uint8_t sec1_pk[SEC1_PUBLIC_KEY_LEN];
+	enum ecdh_op op;
+
+	ARG_UNUSED(work);
+
+	K_SPINLOCK(&lock) {
+		op = pending_op;
+		memcpy(sec1_pk, remote_pk_sec1, sizeof(sec1_pk));
+	}
+
+	struct bt_hci_evt_hdr *hdr = (void *)&evt_buf[0];
+	struct bt_hci_evt_le_meta_event *meta = (void *)&evt_buf[sizeof(*hdr)];
+	uint8_t *params = &evt_buf[sizeof(*hdr) + sizeof(*meta)];
+
+	hdr->evt = BT_HCI_EVT_LE_META_EVENT;
+
+	if (op == ECDH_OP_PUBLIC_KEY) {
+		struct bt_hci_evt_le_p256_public_key_complete *evt = (void *)params;
+
+		meta->subevent = BT_HCI_EVT_LE_P256_PUBLIC_KEY_COMPLETE;
+		evt->status = public_key_get(evt->key);
+		hdr->len = sizeof(*meta) + sizeof(*evt);
+	} else {
+		struct bt_hci_evt_le_generate_dhkey_complete *evt = (void *)params;
+
+		meta->subevent = BT_HCI_EVT_LE_GENERATE_DHKEY_COMPLETE;
+		evt->status = dhkey_get(op, sec1_pk, evt->dhkey);
+		if (evt->status) {
+			memset(evt->dhkey, 0xff, sizeof(evt->dhkey));
+		}
+		hdr->len = sizeof(*meta) + sizeof(*evt);
+	}
+
+	K_SPINLOCK(&lock) {
+		evt_ready = true;
+		pending_op = ECDH_OP_NONE;
+	}
+
+	evt_signal_cb();
+}
+
+#if IS_ENABLED(CONFIG_BT_CTLR_ECDH_PRECOMPUTE_KEY)
+static void precompute_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	if (spare_key == PSA_KEY_ID_NULL && key_generate(&spare_key) != PSA_SUCCESS) {
+		LOG_WRN("P-256 keypair precomputation failed");
+		spare_key = PSA_KEY_ID_NULL;
+	}
+}
+#endif
+
+static uint8_t op_start(enum ecdh_op op, const uint8_t *remote_pk)
+{
+	uint8_t status = BT_HCI_ERR_SUCCESS;
+
+	K_SPINLOCK(&lock) {
+		/* The previous result must have been read before a new one can
+		 * be produced.
+		 */
+		if (pending_op != ECDH_OP_NONE || evt_ready) {
+			status = BT_HCI_ERR_CMD_DISALLOWED;
+			K_SPINLOCK_BREAK;
+		}
+
+		pending_op = op;
+		if (remote_pk) {
+			hci_to_sec1(remote_pk_sec1, remote_pk);
+		}
+	}
+
+	if (status == BT_HCI_ERR_SUCCESS) {
+		mpsl_housekeeping_work_submit(&op_work);
+	}
+
+	return status;
+}
+
+uint8_t ecdh_cmd_le_read_local_p256_public_key(void)
+{
+	return op_start(ECDH_OP_PUBLIC_KEY, NULL);
+}
+
+uint8_t ecdh_cmd_le_generate_dhkey(const uint8_t *remote_pk, uint8_t key_type)
+{
+	switch (key_type) {
+	case BT_HCI_LE_KEY_TYPE_GENERATED:
+		return op_start(ECDH_OP_DHKEY, remote_pk);
+	case BT_HCI_LE_KEY_TYPE_DEBUG:
+		return op_start(ECDH_OP_DHKEY_DEBUG, remote_pk);
+	default:
+		return BT_HCI_ERR_INVALID_PARAM;
+	}
+}
+
+int ecdh_msg_get(uint8_t *msg_out, sdc_hci_msg_type_t *msg_type_out)
+{
+	int err = -EAGAIN;
+
+	K_SPINLOCK(&lock) {
+		if (evt_ready) {
+			const struct bt_hci_evt_hdr *hdr = (const void *)&evt_buf[0];
+
+			memcpy(msg_out, evt_buf, sizeof(*hdr) + hdr->len);
+			memset(evt_buf, 0, sizeof(evt_buf));
+			evt_ready = false;
+			*msg_type_out = SDC_HCI_MSG_TYPE_EVT;
+			err = 0;
+		}
+	}
+
+	return err;
+}
+
+int ecdh_init(void (*evt_signal)(void))
+{
+	evt_signal_cb = evt_signal;
+
+	if (psa_crypto_init() != PSA_SUCCESS) {
+		return -EIO;
+	}
+
+#if IS_ENABLED(CONFIG_BT_CTLR_ECDH_PRECOMPUTE_KEY)
+	mpsl_housekeeping_work_schedule(&precompute_work,
+					K_MSEC(CONFIG_BT_CTLR_ECDH_PRECOMPUTE_DELAY));
+#endif
+
+	return 0;
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file ecdh.h
+ *
+ * @brief P-256 key generation and DHKey computation for the HCI ECC commands.
+ */
+
+#ifndef ECDH_H__
+#define ECDH_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+#include <sdc_hci.h>
+
+/** @brief Initialize the ECDH service.
+ *
+ * Starts generation of the first keypair when
+ * CONFIG_BT_CTLR_ECDH_PRECOMPUTE_KEY is enabled.
+ *
+ * @param evt_signal  Called from the housekeeping queue when an event is
+ *                    ready to be read with ecdh_msg_get().
+ *
+ * @retval 0     Success.
+ * @retval -EIO  PSA Crypto could not be initialized.
+ */
+int ecdh_init(void (*evt_signal)(void));
+
+/** @brief Handle HCI LE Read Local P-256 Public Key.
+ *
+ * The public key is delivered later in an LE Read Local P-256 Public Key
+ * Complete event.
+ *
+ * @return Bluetooth status code for the Command Status event.
+ */
+uint8_t ecdh_cmd_le_read_local_p256_public_key(void);
+
+/** @brief Handle HCI LE Generate DHKey (v1 and v2).
+ *
+ * The DHKey is delivered later in an LE Generate DHKey Complete event.
+ *
+ * @param remote_pk  Remote public key, X then Y, each little-endian.
+ * @param key_type   BT_HCI_LE_KEY_TYPE_GENERATED or BT_HCI_LE_KEY_TYPE_DEBUG.
+ *
+ * @return Bluetooth status code for the Command Status event.
+ */
+uint8_t ecdh_cmd_le_generate_dhkey(const uint8_t *remote_pk, uint8_t key_type);
+
+/** @brief Retrieve a pending ECDH event.
+ *
+ * @param[out] msg_out       Buffer for the HCI event.
+ * @param[out] msg_type_out  Set to SDC_HCI_MSG_TYPE_EVT.
+ *
+ * @retval 0        An event was copied to msg_out.
+ * @retval -EAGAIN  No event is pending.
+ */
+int ecdh_msg_get(uint8_t *msg_out, sdc_hci_msg_type_t *msg_type_out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ECDH_H__ */
@@ -0,0 +1,236 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <errno.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/drivers/entropy.h>
+#include <zephyr/random/random.h>
+#include <zephyr/shell/shell.h>
+#include <mpsl/mpsl_work.h>
+
+#include "entropy_pool.h"
+
+#define LOG_LEVEL CONFIG_BT_HCI_DRIVER_LOG_LEVEL
+#include "zephyr/logging/log.h"
+LOG_MODULE_REGISTER(bt_sdc_entropy_pool);
+
+#define POOL_SIZE CONFIG_BT_CTLR_SDC_ENTROPY_POOL_SIZE
+
+/* Bytes read from the entropy device per refill step, so the housekeeping
+ * queue is not held for the whole pool at once.
+ */
+#define REFILL_CHUNK 16
+#define REFILL_RETRY_MS 5
+
+static const struct device *entropy_dev = DEVICE_DT_GET(DT_CHOSEN(zephyr_entropy));
+
+#if POOL_SIZE > 0
+static struct k_spinlock pool_lock;
+static uint8_t pool[POOL_SIZE];
+static size_t pool_head;
+static size_t pool_count;
+
+static void refill_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(refill_work, refill_work_handler);
+#endif /* POOL_SIZE > 0 */
+
+#if IS_ENABLED(CONFIG_BT_CTLR_SDC_ENTROPY_STATS)
+static struct k_spinlock stats_lock;
+static struct entropy_pool_stats stats;
+#define STATS_INC(_field)                                                                          \
+	do {                                                                                       \
+		k_spinlock_key_t _key = k_spin_lock(&stats_lock);                                  \
+		stats._field++;                                                                    \
+		k_spin_unlock(&stats_lock, _key);                                                  \
+	} while (0)
+#else
+#define STATS_INC(_field)
+#endif /* CONFIG_BT_CTLR_SDC_ENTROPY_STATS */
+
+#if POOL_SIZE > 0
+static bool pool_take(uint8_t *buf, size_t len)
+{
+	bool taken = false;
+	bool refill;
+	k_spinlock_key_t key = k_spin_lock(&pool_lock);
+
+	if (pool_count >= len) {
+		size_t tail = (pool_head + POOL_SIZE - pool_count) % POOL_SIZE;
+		size_t first = MIN(len, POOL_SIZE - tail);
+
+		memcpy(buf, &pool[tail], first);
+		memcpy(buf + first, &pool[0], len - first);
+		/* Never hand out the same bytes twice */
+		memset(&pool[tail], 0, first);
+		memset(&pool[0], 0, len - first);
+		pool_count -= len;
+		taken = true;
+	}
+
+	refill = pool_count <= CONFIG_BT_CTLR_SDC_ENTROPY_POOL_REFILL_THRESHOLD;
+
+	k_spin_unlock(&pool_lock, key);
+
+	if (refill) {
+		mpsl_housekeeping_work_schedule(&refill_work, K_NO_WAIT);
+	}
+
+	return taken;
+}
+
+static void refill_work_handler(struct k_work *work)
+{
+	uint8_t chunk[REFILL_CHUNK];
+	size_t space;
+
+	ARG_UNUSED(work);
+
+	K_SPINLOCK(&pool_lock) {
+		space = POOL_SIZE - pool_count;
+	}
+
+	if (space == 0) {
+		return;
+	}
+
+	/* Take only what the driver already has buffered so the work queue
+	 * never waits for the RNG; fall back to a blocking read for drivers
+	 * without an ISR API.
+	 */
+	int len = entropy_get_entropy_isr(entropy_dev, chunk, MIN(space, sizeof(chunk)), 0);
+
+	if (len == -ENOTSUP || len == -ENOSYS) {
+		len = MIN(space, sizeof(chunk));
+		if (entropy_get_entropy(entropy_dev, chunk, len)) {
+			len = -EIO;
+		}
+	}
+
+	if (len < 0) {
+		LOG_WRN("Entropy pool refill failed (%d)", len);
+		return;
+	}
+
+	K_SPINLOCK(&pool_lock) {
+		len = MIN((size_t)len, POOL_SIZE - pool_count);
+
+		for (int i = 0; i < len; i++) {
+			pool[pool_head] = chunk[i];
+			pool_head = (pool_head + 1) % POOL_SIZE;
+		}
+		pool_count += len;
+		space = POOL_SIZE - pool_count;
+	}
+
+	memset(chunk, 0, sizeof(chunk));
+
+	if (space > 0) {
+		/* Let the driver collect more bytes before the next chunk. */
+		mpsl_housekeeping_work_schedule(&refill_work, K_MSEC(REFILL_RETRY_MS));
+	}
+}
+#endif /* POOL_SIZE > 0 */
+
+static int entropy_blocking_get(uint8_t *buf, size_t len)
+{
+#if IS_ENABLED(CONFIG_BT_CTLR_SDC_ENTROPY_STATS)
+	uint32_t start = k_cycle_get_32();
+#endif
+	int err = entropy_get_entropy(entropy_dev, buf, len);
+
+#if IS_ENABLED(CONFIG_BT_CTLR_SDC_ENTROPY_STATS)
+	uint32_t wait_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+
+	K_SPINLOCK(&stats_lock) {
+		stats.blocking++;
+		stats.blocking_total_us += wait_us;
+		stats.blocking_max_us = MAX(stats.blocking_max_us, wait_us);
+	}
+#endif
+
+	return err ? -EIO : 0;
+}
+
+int entropy_pool_get(uint8_t *buf, size_t len)
+{
+	if (unlikely(!device_is_ready(entropy_dev))) {
+		return -ENODEV;
+	}
+
+	STATS_INC(requests);
+
+#if POOL_SIZE > 0
+	if (pool_take(buf, len)) {
+		STATS_INC(pool_hits);
+		return 0;
+	}
+#endif
+
+#if IS_ENABLED(CONFIG_BT_CTLR_SDC_ENTROPY_POOL_DRBG)
+	if (sys_csrand_get(buf, len) == 0) {
+		STATS_INC(drbg);
+		return 0;
+	}
+#endif
+
+	return entropy_blocking_get(buf, len);
+}
+
+int entropy_pool_init(void)
+{
+	if (!device_is_ready(entropy_dev)) {
+		return -ENODEV;
+	}
+
+#if POOL_SIZE > 0
+	mpsl_housekeeping_work_schedule(&refill_work, K_NO_WAIT);
+#endif
+
+	return 0;
+}
+
+#if IS_ENABLED(CONFIG_BT_CTLR_SDC_ENTROPY_STATS)
+void entropy_pool_stats_get(struct entropy_pool_stats *out, bool reset)
+{
+	K_SPINLOCK(&stats_lock) {
+		*out = stats;
+		if (reset) {
+			memset(&stats, 0, sizeof(stats));
+		}
+	}
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_entropy(const struct shell *sh, size_t argc, char **argv)
+{
+	struct entropy_pool_stats snapshot;
+	bool reset = (argc > 1 && strcmp(argv[1], "reset") == 0);
+	size_t level = 0;
+
+	entropy_pool_stats_get(&snapshot, reset);
+
+#if POOL_SIZE > 0
+	K_SPINLOCK(&pool_lock) {
+		level = pool_count;
+	}
+#endif
+
+	shell_print(sh, "Pool: %zu / %u bytes", level, POOL_SIZE);
+	shell_print(sh, "Requests: %u (pool %u, drbg %u, blocking %u)", snapshot.requests,
+		    snapshot.pool_hits, snapshot.drbg, snapshot.blocking);
+	shell_print(sh, "Blocking wait: total=%llu us avg=%llu us max=%u us",
+		    snapshot.blocking_total_us,
+		    snapshot.blocking ? snapshot.blocking_total_us / snapshot.blocking : 0,
+		    snapshot.blocking_max_us);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((mpsl), entropy, NULL, "Show controller entropy statistics [reset]",
+		 cmd_entropy, 1, 1);
+#endif /* CONFIG_SHELL */
+#endif /* CONFIG_BT_CTLR_SDC_ENTROPY_STATS */
@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file entropy_pool.h
+ *
+ * @brief Background filled entropy pool for the host and the SoftDevice Controller.
+ */
+
+#ifndef ENTROPY_POOL_H__
+#define ENTROPY_POOL_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/sys/util.h>
+
+/** @brief Start filling the pool from the chosen entropy device.
+ *
+ * @retval 0        Success.
+ * @retval -ENODEV  The entropy device is not ready.
+ */
+int entropy_pool_init(void);
+
+/** @brief Get random bytes.
+ *
+ * Served from the pool when it holds enough bytes. Otherwise the request
+ * falls back to the DRBG (CONFIG_BT_CTLR_SDC_ENTROPY_POOL_DRBG) or a
+ * blocking read from the entropy device.
+ *
+ * @param[out] buf  Destination buffer.
+ * @param[in]  len  Number of bytes.
+ *
+ * @retval 0        Success.
+ * @retval -ENODEV  The entropy device is not ready.
+ * @retval -EIO     The entropy source failed.
+ */
+int entropy_pool_get(uint8_t *buf, size_t len);
+
+#if IS_ENABLED(CONFIG_BT_CTLR_SDC_ENTROPY_STATS)
+/** Entropy request statistics. */
+struct entropy_pool_stats {
+	/** Number of requests. */
+	uint32_t requests;
+	/** Requests served from the pool. */
+	uint32_t pool_hits;
+	/** Requests served by the DRBG. */
+	uint32_t drbg;
+	/** Requests that blocked on the entropy device. */
+	uint32_t blocking;
+	/** Total time spent blocking, in microseconds. */
+	uint64_t blocking_total_us;
+	/** Longest single blocking wait, in microseconds. */
+	uint32_t blocking_max_us;
+};
+
+/** @brief Get the entropy request statistics.
+ *
+ * @param[out] stats  Statistics accumulated since boot or the last reset.
+ * @param[in]  reset  Clear the statistics after reading them.
+ */
+void entropy_pool_stats_get(struct entropy_pool_stats *stats, bool reset);
+#endif /* CONFIG_BT_CTLR_SDC_ENTROPY_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ENTROPY_POOL_H__ */
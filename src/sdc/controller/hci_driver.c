@@ -29,6 +29,11 @@
 #include <mpsl/mpsl_lib.h>
 
 #include "multithreading_lock.h"
+#include "mpsl_work_stats.h"
+#include "entropy_pool.h"
+#if defined(CONFIG_BT_CTLR_ECDH)
+#include "ecdh.h"
+#endif
 #include "hci_internal.h"
 #include "radio_nrf5_txp.h"
 #include "cs_antenna_switch.h"
@@ -53,7 +58,11 @@ LOG_MODULE_REGISTER(bt_sdc_hci_driver);
 #define SDC_CENTRAL_COUNT 0
 #endif /* defined(CONFIG_BT_CONN) && defined(CONFIG_BT_CENTRAL) */
 
+#if defined(CONFIG_ZMK_SDC_CENTRAL)
+#define PERIPHERAL_COUNT 0
+#else
 #define PERIPHERAL_COUNT (CONFIG_BT_MAX_CONN - SDC_CENTRAL_COUNT)
+#endif /* CONFIG_ZMK_SDC_CENTRAL */
 
 BUILD_ASSERT(!IS_ENABLED(CONFIG_BT_CENTRAL) ||
 			 (SDC_CENTRAL_COUNT > 0));
@@ -61,6 +70,12 @@ BUILD_ASSERT(!IS_ENABLED(CONFIG_BT_CENTRAL) ||
 BUILD_ASSERT(!IS_ENABLED(CONFIG_BT_PERIPHERAL) ||
 			 (PERIPHERAL_COUNT > 0));
 
+/* The role-limited libraries do not contain code for the other role. */
+BUILD_ASSERT(!IS_ENABLED(CONFIG_ZMK_SDC_PERIPHERAL) || !IS_ENABLED(CONFIG_BT_CENTRAL),
+	     "The peripheral-only SDC variant does not support the central role");
+BUILD_ASSERT(!IS_ENABLED(CONFIG_ZMK_SDC_CENTRAL) || !IS_ENABLED(CONFIG_BT_PERIPHERAL),
+	     "The central-only SDC variant does not support the peripheral role");
+
 
 #if defined(CONFIG_BT_BROADCASTER)
 	#if defined(CONFIG_BT_CTLR_ADV_EXT)
@@ -688,14 +703,16 @@ static void receive_work_handler(struct k_work *work)
 {
 	ARG_UNUSED(work);
 
+	uint32_t stats_start = mpsl_work_stats_begin();
+
 	hci_driver_receive_process();
-}
 
-static const struct device *entropy_source = DEVICE_DT_GET(DT_CHOSEN(zephyr_entropy));
+	mpsl_work_stats_end(MPSL_WORK_STATS_HCI_RX, stats_start);
+}
 
 static void rand_prio_low_vector_get_blocking(uint8_t *p_buff, uint8_t length)
 {
-	int err = entropy_get_entropy(entropy_source, p_buff, length);
+	int err = entropy_pool_get(p_buff, length);
 
 	__ASSERT(err == 0, "The entropy source returned an error in a blocking call");
 	(void) err;
@@ -1048,7 +1065,7 @@ static int configure_memory_usage(void)
 	uint8_t iso_rx_paths = 0;
 #endif
 
-#if !defined(CONFIG_BT_LL_SOFTDEVICE_PERIPHERAL)
+#if !defined(CONFIG_ZMK_SDC_PERIPHERAL)
 	cfg.central_count.count = SDC_CENTRAL_COUNT;
 
 	/* NOTE: sdc_cfg_set() returns a negative errno on error. */
@@ -1061,7 +1078,7 @@ static int configure_memory_usage(void)
 	}
 #endif
 
-#if !defined(CONFIG_BT_LL_SOFTDEVICE_CENTRAL)
+#if !defined(CONFIG_ZMK_SDC_CENTRAL)
 	cfg.peripheral_count.count = PERIPHERAL_COUNT;
 
 	required_memory =
@@ -1095,7 +1112,7 @@ static int configure_memory_usage(void)
 		return required_memory;
 	}
 
-#if defined(CONFIG_BT_BROADCASTER) || defined(CONFIG_BT_LL_SOFTDEVICE_MULTIROLE)
+#if defined(CONFIG_BT_BROADCASTER) || defined(CONFIG_ZMK_SDC_MULTIROLE)
 	cfg.adv_count.count = SDC_ADV_SET_COUNT;
 
 	required_memory =
@@ -1353,10 +1370,19 @@ static int hci_driver_open(const struct device *dev, bt_hci_recv_t recv_func)
 
 	int err;
 
-	if (!device_is_ready(entropy_source)) {
+	err = entropy_pool_init();
+	if (err) {
 		LOG_ERR("Entropy source device not ready");
-		return -ENODEV;
+		return err;
+	}
+
+#if defined(CONFIG_BT_CTLR_ECDH)
+	err = ecdh_init(receive_signal_raise);
+	if (err) {
+		LOG_ERR("Failed to initialize ECDH (%d)", err);
+		return err;
 	}
+#endif
 
 	sdc_rand_source_t rand_functions = {
 		.rand_poll = rand_prio_low_vector_get_blocking
@@ -20,6 +20,9 @@ LOG_MODULE_REGISTER(hci_internal, CONFIG_BT_HCI_DRIVER_LOG_LEVEL);
 
 #include "hci_internal.h"
 #include "hci_internal_wrappers.h"
+#if defined(CONFIG_BT_CTLR_ECDH)
+#include "ecdh.h"
+#endif
 
 #define CMD_COMPLETE_MIN_SIZE (BT_HCI_EVT_HDR_SIZE \
 				+ sizeof(struct bt_hci_evt_cmd_complete) \
@@ -67,6 +70,11 @@ static bool command_generates_command_complete_event(uint16_t hci_opcode)
 	case SDC_HCI_OPCODE_CMD_LE_CREATE_BIG_TEST:
 	case SDC_HCI_OPCODE_CMD_LE_TERMINATE_BIG:
 	case SDC_HCI_OPCODE_CMD_LE_SUBRATE_REQUEST:
+#if defined(CONFIG_BT_CTLR_ECDH)
+	case BT_HCI_OP_LE_P256_PUBLIC_KEY:
+	case BT_HCI_OP_LE_GENERATE_DHKEY:
+	case BT_HCI_OP_LE_GENERATE_DHKEY_V2:
+#endif
 #if defined(CONFIG_BT_CTLR_CHANNEL_SOUNDING)
 	case SDC_HCI_OPCODE_CMD_LE_CS_READ_REMOTE_SUPPORTED_CAPABILITIES:
 	case SDC_HCI_OPCODE_CMD_LE_CS_SECURITY_ENABLE:
@@ -424,6 +432,12 @@ void hci_internal_supported_commands(sdc_hci_ip_supported_commands_t *cmds)
 
 	cmds->hci_le_read_supported_states = 1;
 
+#if defined(CONFIG_BT_CTLR_ECDH)
+	cmds->hci_le_read_local_p256_public_key = 1;
+	cmds->hci_le_generate_dhkey_v1 = 1;
+	cmds->hci_le_generate_dhkey_v2 = 1;
+#endif
+
 	/* NOTE: The DTM commands are *not* supported by the SoftDevice
 	 * controller. See doc/nrf/known_issues.rst.
 	 */
@@ -1106,6 +1120,22 @@ static uint8_t le_controller_cmd_put(uint8_t const * const cmd,
 		le_read_supported_states((void *)event_out_params);
 		return 0;
 
+#if defined(CONFIG_BT_CTLR_ECDH)
+	case BT_HCI_OP_LE_P256_PUBLIC_KEY:
+		return ecdh_cmd_le_read_local_p256_public_key();
+
+	case BT_HCI_OP_LE_GENERATE_DHKEY:
+		return ecdh_cmd_le_generate_dhkey(
+			((const struct bt_hci_cp_le_generate_dhkey *)cmd_params)->key,
+			BT_HCI_LE_KEY_TYPE_GENERATED);
+
+	case BT_HCI_OP_LE_GENERATE_DHKEY_V2: {
+		const struct bt_hci_cp_le_generate_dhkey_v2 *params = (const void *)cmd_params;
+
+		return ecdh_cmd_le_generate_dhkey(params->key, params->key_type);
+	}
+#endif
+
 #if defined(CONFIG_BT_CTLR_DATA_LENGTH)
 	case SDC_HCI_OPCODE_CMD_LE_SET_DATA_LENGTH:
 		*param_length_out += sizeof(sdc_hci_cmd_le_set_data_length_return_t);
@@ -1878,6 +1908,12 @@ int hci_internal_msg_get(uint8_t *msg_out, sdc_hci_msg_type_t *msg_type_out)
 		return 0;
 	}
 
+#if defined(CONFIG_BT_CTLR_ECDH)
+	if (ecdh_msg_get(msg_out, msg_type_out) == 0) {
+		return 0;
+	}
+#endif
+
 	const int retval = sdc_hci_get(msg_out, msg_type_out);
 
 #if defined(CONFIG_BT_CTLR_SDC_PAWR_SYNC)
@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file sdc_crypto.h
+ *
+ * @brief Batched AES-128 ECB and the RPA resolution cache in front of bt_encrypt_le().
+ */
+
+#ifndef SDC_CRYPTO_H__
+#define SDC_CRYPTO_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/** One AES-128 ECB operation. */
+struct sdc_crypto_ecb_block {
+	/** 128-bit key. */
+	const uint8_t *key;
+	/** 128-bit plaintext. */
+	const uint8_t *plaintext;
+	/** 128-bit output, may alias @ref plaintext. */
+	uint8_t *enc_data;
+};
+
+/** @brief Encrypt several blocks, little-endian byte order.
+ *
+ * Same result as bt_encrypt_le() on each block, without the per block debug
+ * logging. Blocks are not looked up in or added to the RPA cache.
+ *
+ * @param[in,out] blocks  Blocks to encrypt.
+ * @param[in]     count   Number of blocks.
+ */
+void sdc_crypto_encrypt_le_batch(const struct sdc_crypto_ecb_block *blocks, size_t count);
+
+/** @brief Encrypt several blocks, big-endian byte order.
+ *
+ * Same result as bt_encrypt_be() on each block, without the per block debug
+ * logging.
+ *
+ * @param[in,out] blocks  Blocks to encrypt.
+ * @param[in]     count   Number of blocks.
+ */
+void sdc_crypto_encrypt_be_batch(const struct sdc_crypto_ecb_block *blocks, size_t count);
+
+#if CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0
+/** RPA resolution cache statistics. */
+struct sdc_crypto_rpa_cache_stats {
+	/** ah() computations served from the cache. */
+	uint32_t hits;
+	/** ah() computations that needed an AES operation. */
+	uint32_t misses;
+};
+
+/** @brief Drop all cached RPA resolution results. Done on every bond deletion. */
+void sdc_crypto_rpa_cache_clear(void);
+
+/** @brief Get the RPA resolution cache statistics.
+ *
+ * @param[out] stats  Statistics accumulated since boot or the last reset.
+ * @param[in]  reset  Clear the statistics after reading them.
+ */
+void sdc_crypto_rpa_cache_stats_get(struct sdc_crypto_rpa_cache_stats *stats, bool reset);
+#endif /* CONFIG_BT_CTLR_SDC_RPA_CACHE_SIZE > 0 */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SDC_CRYPTO_H__ */
@@ -0,0 +1,155 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file mpsl_hfclk.h
+ *
+ * @defgroup mpsl_hfclk Reference counted HFXO requests.
+ *
+ * @brief Non-radio HFXO requests with per-requester accounting.
+ * @{
+ */
+
+#ifndef MPSL_HFCLK__
+#define MPSL_HFCLK__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+
+/** @brief Request the HFXO on behalf of a named requester.
+ *
+ * Requests are reference counted. The crystal is requested from MPSL on
+ * the first request and released with the last release.
+ *
+ * @param requester  Static string naming the requester. Requesters are
+ *                   matched by pointer.
+ */
+void mpsl_hfclk_request(const char *requester);
+
+/** @brief Release an HFXO request made with mpsl_hfclk_request().
+ *
+ * @param requester  The string passed to mpsl_hfclk_request().
+ */
+void mpsl_hfclk_release(const char *requester);
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_RADIO_ALIGN)
+struct mpsl_hfclk_aligned_req;
+
+/** @brief Called when the HFXO runs for an aligned request.
+ *
+ * Runs in interrupt context, or in the context that issued the request if
+ * the HFXO was already running. No driver lock is held, so it may call
+ * mpsl_hfclk_release() or submit the request again. The request now holds
+ * the HFXO like mpsl_hfclk_request() and is finished with
+ * mpsl_hfclk_release().
+ */
+typedef void (*mpsl_hfclk_aligned_cb_t)(struct mpsl_hfclk_aligned_req *req);
+
+/** HFXO request that waits for the next radio event. */
+struct mpsl_hfclk_aligned_req {
+	/** Requester name, see mpsl_hfclk_request(). */
+	const char *requester;
+	/** Called once the HFXO runs. */
+	mpsl_hfclk_aligned_cb_t started;
+
+	/* Private */
+	sys_snode_t node;
+	struct k_timer deadline;
+};
+
+/** @brief Request the HFXO together with the next radio event.
+ *
+ * The request is issued when MPSL signals that the radio becomes active,
+ * so the crystal ramps once for both. If no radio event comes within
+ * @p max_delay, or the HFXO is already running, it is issued right away.
+ *
+ * @param req        Request. Must stay valid until @c started has run.
+ * @param max_delay  Longest time the request may wait for the radio.
+ *
+ * @retval 0       The request waits for the radio or was issued.
+ * @retval -EBUSY  @p req is still waiting or starting; @c started has not
+ *                 run yet.
+ */
+int mpsl_hfclk_request_aligned(struct mpsl_hfclk_aligned_req *req, k_timeout_t max_delay);
+
+/** @brief Cancel an aligned request still waiting for the radio.
+ *
+ * @retval 0          The request was withdrawn.
+ * @retval -EALREADY  The HFXO was already requested; release it as usual.
+ */
+int mpsl_hfclk_request_aligned_cancel(struct mpsl_hfclk_aligned_req *req);
+
+/** Outcome of aligned requests since boot. */
+struct mpsl_hfclk_aligned_stats {
+	/** Issued with a radio event; each one is a crystal ramp saved. */
+	uint32_t radio;
+	/** Issued right away because the HFXO was running or no delay was allowed. */
+	uint32_t running;
+	/** Issued alone after the deadline passed. */
+	uint32_t deadline;
+};
+
+/** @brief Get the aligned request statistics. */
+void mpsl_hfclk_aligned_stats_get(struct mpsl_hfclk_aligned_stats *stats);
+#endif /* CONFIG_MPSL_HFCLK_RADIO_ALIGN */
+
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_ACCOUNTING)
+/** Accounting for one HFXO requester. */
+struct mpsl_hfclk_requester_stats {
+	/** Requester name. */
+	const char *name;
+	/** Outstanding requests. */
+	uint32_t refcount;
+	/** Number of requests made. */
+	uint32_t requests;
+	/** Uptime of the last first request, in milliseconds. */
+	int64_t last_request_ms;
+	/** Uptime of the last final release, in milliseconds. */
+	int64_t last_release_ms;
+	/** Time with at least one outstanding request, in milliseconds. */
+	uint64_t on_time_ms;
+};
+
+/** HFXO accounting summary. */
+struct mpsl_hfclk_stats {
+	/** Outstanding requests over all requesters. */
+	uint32_t refcount;
+	/** Time the HFXO was held by any requester, in milliseconds. */
+	uint64_t on_time_ms;
+	/** Uptime of the last statistics reset, in milliseconds. */
+	int64_t since_ms;
+};
+
+/** @brief Get the HFXO accounting.
+ *
+ * Time of requests still outstanding is included up to now.
+ *
+ * @param[out] stats       Summary over all requesters.
+ * @param[out] requesters  Per-requester accounting.
+ * @param[in]  max         Capacity of @p requesters.
+ * @param[in]  reset       Clear the accumulated figures after reading them.
+ *
+ * @return Number of entries written to @p requesters.
+ */
+size_t mpsl_hfclk_stats_get(struct mpsl_hfclk_stats *stats,
+			    struct mpsl_hfclk_requester_stats *requesters, size_t max,
+			    bool reset);
+#endif /* CONFIG_MPSL_HFCLK_ACCOUNTING */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPSL_HFCLK__ */
+
+/**@} */
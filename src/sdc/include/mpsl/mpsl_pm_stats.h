@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file mpsl_pm_stats.h
+ *
+ * @defgroup mpsl_pm_stats Radio event gap statistics.
+ *
+ * @brief Attribute the gaps between radio events to application states.
+ * @{
+ */
+
+#ifndef MPSL_PM_STATS__
+#define MPSL_PM_STATS__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** @brief Account the following radio event gaps to @p tag.
+ *
+ * Lets the gap statistics shown by "mpsl pm" be split by an application
+ * state such as the connection subrating tier. Gaps are accounted to tag
+ * 0 until this is called.
+ *
+ * @param tag   Tag index. Indices beyond CONFIG_MPSL_PM_STATS_TAGS share
+ *              the last tag.
+ * @param name  Static string naming the tag in the shell output.
+ */
+void mpsl_pm_stats_tag_set(uint8_t tag, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPSL_PM_STATS__ */
+
+/**@} */
@@ -0,0 +1,130 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file mpsl_radio_notif.h
+ *
+ * @defgroup mpsl_radio_notif MPSL radio activity notifications.
+ *
+ * @brief "Radio active soon" and "radio idle" signals, and work that is
+ *        held back until the radio is idle.
+ * @{
+ */
+
+#ifndef MPSL_RADIO_NOTIF__
+#define MPSL_RADIO_NOTIF__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/slist.h>
+
+/** Radio notification listener. Callbacks run in the notification ISR. */
+struct mpsl_radio_notif_listener {
+	sys_snode_t node;
+	/** The radio becomes active within the configured distance. */
+	void (*active_soon)(void);
+	/** The radio has become inactive. */
+	void (*idle)(void);
+};
+
+/** @brief Add a listener. Listeners cannot be removed. */
+void mpsl_radio_notif_listener_add(struct mpsl_radio_notif_listener *listener);
+
+/** @brief Check whether the radio is between events.
+ *
+ * @return true from the "idle" notification until the next "active soon".
+ */
+bool mpsl_radio_notif_is_idle(void);
+
+/** Work item that runs in a radio idle gap. */
+struct mpsl_radio_idle_work {
+	/** Work item passed to the handler. */
+	struct k_work work;
+
+	/* Private */
+	k_work_handler_t handler;
+	struct k_work_q *queue;
+	sys_snode_t node;
+	bool deferred;
+};
+
+/** @brief Initialize a radio idle work item.
+ *
+ * @param idle_work  Work item.
+ * @param handler    Handler, called with &idle_work->work.
+ */
+void mpsl_radio_idle_work_init(struct mpsl_radio_idle_work *idle_work, k_work_handler_t handler);
+
+/** @brief Submit work to run when the radio is idle.
+ *
+ * Submitted to @p queue right away if the radio is idle, otherwise at the
+ * next "idle" notification. Suited to CPU heavy work that should not be
+ * preempted by connection event ISRs, e.g. display updates or batched
+ * settings writes.
+ *
+ * @param idle_work  Work item.
+ * @param queue      Queue to run on, NULL for the system work queue.
+ *
+ * @retval 0  Submitted or deferred to the next idle gap.
+ * @retval 1  Already deferred.
+ * @retval <0 Error from k_work_submit_to_queue().
+ */
+int mpsl_radio_idle_work_submit(struct mpsl_radio_idle_work *idle_work, struct k_work_q *queue);
+
+/** @brief Configure MPSL radio notifications and enable the IRQ.
+ *
+ * Called by MPSL initialization after mpsl_init().
+ *
+ * @return Zero on success or (negative) error code otherwise.
+ */
+int mpsl_radio_notif_init(void);
+
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION_STATS)
+/** ISR preemption of radio idle work. */
+struct mpsl_radio_notif_stats {
+	/** "Active soon" notifications. */
+	uint32_t active;
+	/** Edges taken as "active soon" after an edge was lost. */
+	uint32_t resync;
+	/** Work items submitted while the radio was idle. */
+	uint32_t immediate;
+	/** Work items held back until the radio was idle. */
+	uint32_t deferred;
+	/** Work item runs. */
+	uint32_t runs;
+	/** Runs during which an MPSL radio ISR ran. */
+	uint32_t preempted;
+	/** Total time spent in work items, in microseconds. */
+	uint64_t work_us;
+	/** MPSL radio ISR time inside work items, in microseconds. */
+	uint64_t isr_us;
+};
+
+/** @brief Account time spent in an MPSL high priority ISR.
+ *
+ * @param cycles  ISR duration in k_cycle_get_32() cycles.
+ */
+void mpsl_radio_notif_isr_account(uint32_t cycles);
+
+/** @brief Get the idle work statistics.
+ *
+ * @param[out] stats  Statistics accumulated since boot or the last reset.
+ * @param[in]  reset  Clear the statistics after reading them.
+ */
+void mpsl_radio_notif_stats_get(struct mpsl_radio_notif_stats *stats, bool reset);
+#endif /* CONFIG_MPSL_RADIO_NOTIFICATION_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPSL_RADIO_NOTIF__ */
+
+/**@} */
@@ -48,6 +48,53 @@ static inline void mpsl_work_reschedule(struct k_work_delayable *dwork, k_timeou
 	}
 }
 
+#if IS_ENABLED(CONFIG_MPSL_HOUSEKEEPING_WORK_Q)
+extern struct k_work_q mpsl_housekeeping_work_q;
+#define MPSL_HOUSEKEEPING_WORK_Q (&mpsl_housekeeping_work_q)
+#else
+#define MPSL_HOUSEKEEPING_WORK_Q (&mpsl_work_q)
+#endif /* CONFIG_MPSL_HOUSEKEEPING_WORK_Q */
+
+/** @brief Submit a work item to the MPSL housekeeping work queue.
+ *
+ * The housekeeping queue is the MPSL work queue unless
+ * CONFIG_MPSL_HOUSEKEEPING_WORK_Q is enabled.
+ */
+static inline void mpsl_housekeeping_work_submit(struct k_work *work)
+{
+	if (k_work_submit_to_queue(MPSL_HOUSEKEEPING_WORK_Q, work) < 0) {
+		__ASSERT(false, "k_work_submit_to_queue() failed.");
+	}
+}
+
+/** @brief Submit an idle work item to the MPSL housekeeping work queue after a delay. */
+static inline void mpsl_housekeeping_work_schedule(struct k_work_delayable *dwork,
+						   k_timeout_t delay)
+{
+	if (k_work_schedule_for_queue(MPSL_HOUSEKEEPING_WORK_Q, dwork, delay) < 0) {
+		__ASSERT(false, "k_work_schedule_for_queue() failed.");
+	}
+}
+
+#if IS_ENABLED(CONFIG_MPSL_LOW_PRIO_LATENCY_STATS)
+/** @brief Queueing delay of MPSL low priority processing. */
+struct mpsl_low_prio_latency {
+	/** Number of mpsl_low_priority_process() runs measured. */
+	uint32_t count;
+	/** Largest delay from IRQ to processing, in microseconds. */
+	uint32_t max_us;
+	/** Sum of all measured delays, in microseconds. */
+	uint64_t total_us;
+};
+
+/** @brief Get the MPSL low priority queueing delay statistics.
+ *
+ * @param[out] stats  Statistics accumulated since boot or the last reset.
+ * @param[in]  reset  Clear the statistics after reading them.
+ */
+void mpsl_low_prio_latency_get(struct mpsl_low_prio_latency *stats, bool reset);
+#endif /* CONFIG_MPSL_LOW_PRIO_LATENCY_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* Radio synchronization for the nRF flash driver using MPSL timeslots.
+ *
+ * Every erase or write chunk runs inside a timeslot granted by the MPSL
+ * scheduler, so the CPU is never stalled by the NVMC across a connection
+ * event. Operations longer than one timeslot are split by the flash driver
+ * using nrf_flash_sync_check_time_limit() and continue in the next slot.
+ */
+
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <hal/nrf_timer.h>
+#include <mpsl.h>
+#include <mpsl_timeslot.h>
+
+#include <soc_flash_nrf.h>
+
+#include "multithreading_lock.h"
+#include "flash_sync_sched.h"
+
+LOG_MODULE_REGISTER(flash_sync_mpsl, CONFIG_MPSL_LOG_LEVEL);
+
+/* MPSL starts TIMER0 at 1 MHz from zero at the beginning of every timeslot */
+#define TIMESLOT_TIMER NRF_TIMER0
+#define TIMESLOT_TIMER_CHANNEL NRF_TIMER_CC_CHANNEL0
+
+struct sync_context {
+	mpsl_timeslot_session_id_t session_id;
+	bool session_open;
+	struct flash_op_desc *op_desc;
+	mpsl_timeslot_request_t request;
+	mpsl_timeslot_signal_return_param_t return_param;
+	uint32_t length_us;
+	struct flash_sync_sched sched;
+	int result;
+	struct k_sem done;
+};
+
+static struct sync_context _context;
+
+#if IS_ENABLED(CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_STATS)
+/* Only written from the timeslot callback and with the flash mutex held */
+static struct {
+	uint32_t ops;
+	uint32_t slots;
+	uint32_t blocked;
+	uint32_t cancelled;
+	uint32_t timeouts;
+	uint32_t max_slot_us;
+	uint64_t busy_us;
+} stats;
+#define STATS_INC(_field)                                                                          \
+	do {                                                                                       \
+		stats._field++;                                                                    \
+	} while (0)
+#else
+#define STATS_INC(_field)
+#endif /* CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_STATS */
+
+static uint32_t timeslot_time_us(void)
+{
+	nrf_timer_task_trigger(TIMESLOT_TIMER, nrf_timer_capture_task_get(TIMESLOT_TIMER_CHANNEL));
+
+	return nrf_timer_cc_get(TIMESLOT_TIMER, TIMESLOT_TIMER_CHANNEL);
+}
+
+static void request_priority_update(void)
+{
+	_context.request.params.earliest.priority = _context.sched.high_prio
+							    ? MPSL_TIMESLOT_PRIORITY_HIGH
+							    : MPSL_TIMESLOT_PRIORITY_NORMAL;
+}
+
+static mpsl_timeslot_signal_return_param_t *timeslot_callback(
+	mpsl_timeslot_session_id_t session_id, uint32_t signal)
+{
+	mpsl_timeslot_signal_return_param_t *ret = &_context.return_param;
+	int rc;
+
+	ARG_UNUSED(session_id);
+
+	switch (signal) {
+	case MPSL_TIMESLOT_SIGNAL_START:
+		flash_sync_sched_granted(&_context.sched);
+		rc = _context.op_desc->handler(_context.op_desc->context);
+		STATS_INC(slots);
+#if IS_ENABLED(CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_STATS)
+		uint32_t used_us = timeslot_time_us();
+
+		stats.max_slot_us = MAX(stats.max_slot_us, used_us);
+		stats.busy_us += used_us;
+#endif
+		if (rc == FLASH_OP_ONGOING) {
+			request_priority_update();
+			ret->callback_action = MPSL_TIMESLOT_SIGNAL_ACTION_REQUEST;
+			ret->params.request.p_next = &_context.request;
+		} else {
+			_context.result = rc;
+			ret->callback_action = MPSL_TIMESLOT_SIGNAL_ACTION_END;
+		}
+		return ret;
+
+	case MPSL_TIMESLOT_SIGNAL_BLOCKED:
+	case MPSL_TIMESLOT_SIGNAL_CANCELLED:
+		if (signal == MPSL_TIMESLOT_SIGNAL_BLOCKED) {
+			STATS_INC(blocked);
+		} else {
+			STATS_INC(cancelled);
+		}
+
+		/* Radio activity won; ask again */
+		flash_sync_sched_blocked(&_context.sched);
+		request_priority_update();
+		rc = mpsl_timeslot_request(_context.session_id, &_context.request);
+		if (rc) {
+			LOG_ERR("Timeslot re-request failed (%d)", rc);
+			_context.result = -EIO;
+			k_sem_give(&_context.done);
+		}
+		break;
+
+	case MPSL_TIMESLOT_SIGNAL_SESSION_IDLE:
+		k_sem_give(&_context.done);
+		break;
+
+	case MPSL_TIMESLOT_SIGNAL_SESSION_CLOSED:
+		break;
+
+	default:
+		LOG_ERR("Unexpected timeslot signal %u", signal);
+		break;
+	}
+
+	ret->callback_action = MPSL_TIMESLOT_SIGNAL_ACTION_NONE;
+
+	return ret;
+}
+
+int nrf_flash_sync_init(void)
+{
+	k_sem_init(&_context.done, 0, 1);
+
+	return 0;
+}
+
+void nrf_flash_sync_set_context(uint32_t duration)
+{
+	_context.length_us = duration;
+}
+
+bool nrf_flash_sync_is_required(void)
+{
+	return mpsl_is_initialized();
+}
+
+int nrf_flash_sync_exe(struct flash_op_desc *op_desc)
+{
+	int err;
+
+	err = MULTITHREADING_LOCK_ACQUIRE();
+	if (err) {
+		return err;
+	}
+
+	/* The session stays open between operations; it is reserved anyway */
+	if (!_context.session_open) {
+		err = mpsl_timeslot_session_open(timeslot_callback, &_context.session_id);
+		if (err) {
+			MULTITHREADING_LOCK_RELEASE();
+			LOG_ERR("Timeslot session open failed (%d)", err);
+			return -ENOMEM;
+		}
+		_context.session_open = true;
+	}
+
+	_context.op_desc = op_desc;
+	_context.result = 0;
+	flash_sync_sched_start(&_context.sched, _context.length_us);
+	k_sem_reset(&_context.done);
+
+	_context.request = (mpsl_timeslot_request_t){
+		.request_type = MPSL_TIMESLOT_REQ_TYPE_EARLIEST,
+		.params.earliest = {
+			.hfclk = MPSL_TIMESLOT_HFCLK_CFG_NO_GUARANTEE,
+			.priority = MPSL_TIMESLOT_PRIORITY_NORMAL,
+			.length_us = _context.length_us,
+			.timeout_us = MPSL_TIMESLOT_EARLIEST_TIMEOUT_MAX_US,
+		},
+	};
+
+	err = mpsl_timeslot_request(_context.session_id, &_context.request);
+	MULTITHREADING_LOCK_RELEASE();
+
+	if (err) {
+		LOG_ERR("Timeslot request failed (%d)", err);
+		return -EIO;
+	}
+
+	STATS_INC(ops);
+
+	if (k_sem_take(&_context.done,
+		       K_MSEC(CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_TIMEOUT_MS)) != 0) {
+		STATS_INC(timeouts);
+		LOG_ERR("Flash operation timed out");
+
+		/* Closing the session drops the outstanding request; a new one
+		 * is opened for the next operation.
+		 */
+		if (!MULTITHREADING_LOCK_ACQUIRE_FOREVER_WAIT()) {
+			mpsl_timeslot_session_close(_context.session_id);
+			_context.session_open = false;
+			MULTITHREADING_LOCK_RELEASE();
+		}
+		return -ETIMEDOUT;
+	}
+
+	return _context.result;
+}
+
+void nrf_flash_sync_get_timestamp_begin(void)
+{
+	/* The timeslot timer starts from zero, nothing to capture */
+}
+
+bool nrf_flash_sync_check_time_limit(uint32_t iteration)
+{
+	return flash_sync_sched_time_limit(&_context.sched, timeslot_time_us(), iteration);
+}
+
+#if IS_ENABLED(CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_STATS) && IS_ENABLED(CONFIG_SHELL)
+static int cmd_flash(const struct shell *sh, size_t argc, char **argv)
+{
+	shell_print(sh, "Operations: %u, timeslots: %u, timeouts: %u", stats.ops, stats.slots,
+		    stats.timeouts);
+	shell_print(sh, "Timeslots blocked: %u, cancelled: %u", stats.blocked, stats.cancelled);
+	shell_print(sh, "Flash busy %llu us, longest slot %u us", stats.busy_us,
+		    stats.max_slot_us);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((mpsl), flash, NULL, "Show timeslot synchronized flash statistics", cmd_flash,
+		 1, 0);
+#endif /* CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_STATS && CONFIG_SHELL */
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "flash_sync_sched.h"
+
+void flash_sync_sched_start(struct flash_sync_sched *sched, uint32_t length_us)
+{
+	sched->length_us = length_us;
+	sched->high_prio = false;
+}
+
+void flash_sync_sched_granted(struct flash_sync_sched *sched)
+{
+	sched->high_prio = false;
+}
+
+void flash_sync_sched_blocked(struct flash_sync_sched *sched)
+{
+	sched->high_prio = true;
+}
+
+bool flash_sync_sched_time_limit(const struct flash_sync_sched *sched, uint32_t now_us,
+				 uint32_t iteration)
+{
+	uint32_t per_iteration_us = now_us / (iteration ? iteration : 1);
+
+	return now_us + per_iteration_us + FLASH_SYNC_SCHED_END_MARGIN_US >= sched->length_us;
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file flash_sync_sched.h
+ *
+ * @brief Timeslot scheduling decisions of the MPSL flash synchronization.
+ *
+ * Kept free of kernel and MPSL dependencies so the schedule can be tested
+ * on the host.
+ */
+
+#ifndef FLASH_SYNC_SCHED_H__
+#define FLASH_SYNC_SCHED_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/** Give up the slot this long before its end, MPSL asserts on overstay. */
+#define FLASH_SYNC_SCHED_END_MARGIN_US 100
+
+/** Schedule of one flash operation. */
+struct flash_sync_sched {
+	/** Timeslot length, in microseconds. */
+	uint32_t length_us;
+
+	/* State, read only outside the schedule */
+	bool high_prio;
+};
+
+/** @brief Start an operation at normal priority.
+ *
+ * @param sched      Schedule.
+ * @param length_us  Timeslot length requested from MPSL.
+ */
+void flash_sync_sched_start(struct flash_sync_sched *sched, uint32_t length_us);
+
+/** @brief A timeslot was granted; the next one is requested at normal priority. */
+void flash_sync_sched_granted(struct flash_sync_sched *sched);
+
+/** @brief A request was blocked or cancelled by radio activity.
+ *
+ * The next request is made at high priority, so a busy link cannot starve
+ * the operation indefinitely.
+ */
+void flash_sync_sched_blocked(struct flash_sync_sched *sched);
+
+/** @brief Check whether another flash iteration would overrun the slot.
+ *
+ * Assumes the next iteration takes as long as the average so far.
+ *
+ * @param sched      Schedule.
+ * @param now_us     Time since the start of the slot.
+ * @param iteration  Iterations done in this slot, at least 1.
+ *
+ * @return true if the handler has to stop and continue in the next slot.
+ */
+bool flash_sync_sched_time_limit(const struct flash_sync_sched *sched, uint32_t now_us,
+				 uint32_t iteration);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FLASH_SYNC_SCHED_H__ */
@@ -0,0 +1,29 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+
+#include "mpsl_calibration_sched.h"
+
+void mpsl_calibration_sched_reset(struct mpsl_calibration_sched *sched, int32_t temp)
+{
+	sched->ref_temp = temp;
+	sched->period_ms = sched->base_ms;
+	sched->stable_count = 0;
+}
+
+uint32_t mpsl_calibration_sched_next(struct mpsl_calibration_sched *sched, int32_t temp)
+{
+	if (abs(temp - sched->ref_temp) >= sched->temp_diff) {
+		mpsl_calibration_sched_reset(sched, temp);
+	} else if (++sched->stable_count >= sched->stable_readings) {
+		sched->period_ms = sched->period_ms * 2 < sched->max_ms ? sched->period_ms * 2
+									 : sched->max_ms;
+		sched->stable_count = 0;
+	}
+
+	return sched->period_ms;
+}
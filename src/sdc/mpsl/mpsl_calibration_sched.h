@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file mpsl_calibration_sched.h
+ *
+ * @brief Adaptive RC calibration period from die temperature readings.
+ *
+ * Kept free of kernel dependencies so the schedule can be tested on the
+ * host.
+ */
+
+#ifndef MPSL_CALIBRATION_SCHED_H__
+#define MPSL_CALIBRATION_SCHED_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Calibration schedule. The first four fields are configuration. */
+struct mpsl_calibration_sched {
+	/** Period while the temperature moves, in milliseconds. */
+	uint32_t base_ms;
+	/** Longest stretched period, in milliseconds. */
+	uint32_t max_ms;
+	/** Temperature change that resets the period, in 0.25 degree units. */
+	int32_t temp_diff;
+	/** Stable readings before the period is doubled. */
+	uint8_t stable_readings;
+
+	/* State, read only outside the schedule */
+	int32_t ref_temp;
+	uint32_t period_ms;
+	uint8_t stable_count;
+};
+
+/** @brief Start at the base period with @p temp as the reference reading.
+ *
+ * @param sched  Schedule with the configuration fields set.
+ * @param temp   Die temperature in 0.25 degree units.
+ */
+void mpsl_calibration_sched_reset(struct mpsl_calibration_sched *sched, int32_t temp);
+
+/** @brief Get the period until the next calibration run.
+ *
+ * The period doubles, up to @c max_ms, after @c stable_readings
+ * consecutive readings within @c temp_diff of the reference reading, and
+ * returns to @c base_ms as soon as a reading is not. Comparing against a
+ * reference rather than the previous reading catches slow drift too.
+ *
+ * @param sched  Schedule.
+ * @param temp   Die temperature of this run in 0.25 degree units.
+ *
+ * @return Period in milliseconds.
+ */
+uint32_t mpsl_calibration_sched_next(struct mpsl_calibration_sched *sched, int32_t temp);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPSL_CALIBRATION_SCHED_H__ */
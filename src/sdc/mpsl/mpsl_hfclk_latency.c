@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#include <mpsl_clock.h>
+#include <mpsl/mpsl_hfclk.h>
+#include <mpsl/mpsl_work.h>
+
+#include "multithreading_lock.h"
+#include "mpsl_hfclk_latency.h"
+
+LOG_MODULE_REGISTER(mpsl_hfclk_latency, CONFIG_MPSL_LOG_LEVEL);
+
+#define REQUESTER mpsl_hfclk_latency_requester
+/* Longer than any HFXO startup, so the sample is in before the release */
+#define HOLD_MS 10
+#define SAMPLE_SPACING_MS 1000
+
+static struct k_spinlock lock;
+static uint32_t configured_us;
+static uint32_t applied_us;
+/* Learned worst case without margin, 0 while unknown */
+static uint32_t learned_us;
+/* Value in settings, 0 if none */
+static uint32_t stored_us;
+
+/* Current burst */
+static uint32_t burst_samples;
+static uint32_t burst_max_us;
+static uint32_t burst_min_us = UINT32_MAX;
+
+static uint32_t remaining;
+static bool holding;
+
+static void measure_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(measure_work, measure_work_handler);
+
+static void burst_work_handler(struct k_work *work);
+static K_WORK_DEFINE(burst_work, burst_work_handler);
+
+const char mpsl_hfclk_latency_requester[] = "latency_cal";
+
+static uint32_t floor_us(void)
+{
+	return configured_us > CONFIG_MPSL_HFCLK_LATENCY_MAX_REDUCTION
+		       ? configured_us - CONFIG_MPSL_HFCLK_LATENCY_MAX_REDUCTION
+		       : 0;
+}
+
+/* A bad burst must not cut the latency below what the board was set up
+ * with by more than the allowed reduction.
+ */
+static uint32_t with_margin(uint32_t us)
+{
+	return MAX(us + CONFIG_MPSL_HFCLK_LATENCY_MARGIN, floor_us());
+}
+
+static void latency_apply(uint32_t us)
+{
+	if (us == applied_us) {
+		return;
+	}
+
+	if (MULTITHREADING_LOCK_ACQUIRE_FOREVER_WAIT()) {
+		return;
+	}
+
+	mpsl_clock_hfclk_latency_set(us);
+	MULTITHREADING_LOCK_RELEASE();
+
+	LOG_INF("HFCLK latency %u us (configured %u us)", us, configured_us);
+	applied_us = us;
+}
+
+uint32_t mpsl_hfclk_latency_init(uint32_t configured)
+{
+	configured_us = configured;
+	applied_us = learned_us ? with_margin(learned_us) : configured;
+
+	return applied_us;
+}
+
+void mpsl_hfclk_latency_sample(uint32_t latency_us)
+{
+	K_SPINLOCK(&lock) {
+		burst_samples++;
+		burst_max_us = MAX(burst_max_us, latency_us);
+		burst_min_us = MIN(burst_min_us, latency_us);
+	}
+}
+
+static void burst_work_handler(struct k_work *work)
+{
+	uint32_t samples;
+	uint32_t max_us;
+
+	ARG_UNUSED(work);
+
+	K_SPINLOCK(&lock) {
+		samples = burst_samples;
+		max_us = burst_max_us;
+	}
+
+	if (samples == 0) {
+		LOG_WRN("No HFCLK startup measured, keeping %u us", applied_us);
+		return;
+	}
+
+	/* Follow a slower crystal at once, a faster one only gradually. */
+	uint32_t learned = MAX(max_us, learned_us - learned_us / 8);
+
+	LOG_DBG("HFCLK startup %u samples, max %u us, learned %u us", samples, max_us,
+		learned);
+
+	learned_us = learned;
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+	/* The value decays a little every burst; only write flash when it
+	 * moved far enough to matter after a reboot.
+	 */
+	if (stored_us == 0 ||
+	    abs((int32_t)learned_us - (int32_t)stored_us) >=
+		    CONFIG_MPSL_HFCLK_LATENCY_SAVE_THRESHOLD) {
+		int err = settings_save_one("mpsl/hfclk/latency", &learned_us,
+					    sizeof(learned_us));
+
+		if (err) {
+			LOG_WRN("Failed to store HFCLK latency (%d)", err);
+		} else {
+			stored_us = learned_us;
+		}
+	}
+#endif
+
+	latency_apply(with_margin(learned_us));
+}
+
+static void measure_work_handler(struct k_work *work)
+{
+	ARG_UNUSED(work);
+
+	if (holding) {
+		mpsl_hfclk_release(REQUESTER);
+		holding = false;
+
+		if (--remaining > 0) {
+			mpsl_housekeeping_work_schedule(&measure_work, K_MSEC(SAMPLE_SPACING_MS));
+			return;
+		}
+
+		mpsl_housekeeping_work_submit(&burst_work);
+
+		if (CONFIG_MPSL_HFCLK_LATENCY_MEASURE_INTERVAL > 0) {
+			mpsl_housekeeping_work_schedule(
+				&measure_work, K_SECONDS(CONFIG_MPSL_HFCLK_LATENCY_MEASURE_INTERVAL));
+		}
+		return;
+	}
+
+	if (remaining == 0) {
+		/* New burst */
+		remaining = CONFIG_MPSL_HFCLK_LATENCY_MEASURE_SAMPLES;
+		K_SPINLOCK(&lock) {
+			burst_samples = 0;
+			burst_max_us = 0;
+			burst_min_us = UINT32_MAX;
+		}
+	}
+
+	/* Only counts as a sample if the crystal was off; the clock driver
+	 * checks that when the request is made.
+	 */
+	mpsl_hfclk_request(REQUESTER);
+	holding = true;
+	mpsl_housekeeping_work_schedule(&measure_work, K_MSEC(HOLD_MS));
+}
+
+void mpsl_hfclk_latency_measure_start(void)
+{
+	mpsl_housekeeping_work_schedule(&measure_work, K_MSEC(SAMPLE_SPACING_MS));
+}
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+static int latency_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+				void *cb_arg)
+{
+	uint32_t value;
+
+	if (!settings_name_steq(name, "latency", NULL)) {
+		return -ENOENT;
+	}
+
+	if (len != sizeof(value) || read_cb(cb_arg, &value, sizeof(value)) != sizeof(value)) {
+		return -EINVAL;
+	}
+
+	/* Use the value from an earlier boot until the first burst of this
+	 * boot has completed.
+	 */
+	stored_us = value;
+	if (learned_us == 0 && value > 0) {
+		learned_us = value;
+		if (configured_us) {
+			latency_apply(with_margin(learned_us));
+		}
+	}
+
+	return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(mpsl_hfclk, "mpsl/hfclk", NULL, latency_settings_set, NULL,
+			       NULL);
+#endif /* CONFIG_SETTINGS */
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_hfclk_latency(const struct shell *sh, size_t argc, char **argv)
+{
+	uint32_t samples, max_us, min_us;
+
+	K_SPINLOCK(&lock) {
+		samples = burst_samples;
+		max_us = burst_max_us;
+		min_us = burst_min_us;
+	}
+
+	int32_t saved_us = (int32_t)configured_us - (int32_t)applied_us;
+	/* uA * us = pC */
+	int32_t saved_pc = saved_us * CONFIG_MPSL_HFCLK_LATENCY_HFXO_CURRENT_UA;
+
+	shell_print(sh, "Configured %u us, applied %u us, learned %u us + %u us margin",
+		    configured_us, applied_us, learned_us, CONFIG_MPSL_HFCLK_LATENCY_MARGIN);
+	shell_print(sh, "Floor %u us, stored %u us", floor_us(), stored_us);
+	if (samples) {
+		shell_print(sh, "Last burst: %u samples, min %u us, max %u us", samples, min_us,
+			    max_us);
+	}
+	shell_print(sh, "Saved per radio event: %d us, %s%d.%03d nC at %u uA", saved_us,
+		    saved_pc < 0 ? "-" : "", abs(saved_pc) / 1000, abs(saved_pc) % 1000,
+		    CONFIG_MPSL_HFCLK_LATENCY_HFXO_CURRENT_UA);
+
+	return 0;
+}
+
+SHELL_SUBCMD_ADD((mpsl), hfclk_latency, NULL, "Show measured HFCLK startup latency",
+		 cmd_hfclk_latency, 1, 0);
+#endif /* CONFIG_SHELL */
@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file mpsl_hfclk_latency.h
+ *
+ * @brief Measured HFXO startup latency for mpsl_clock_hfclk_latency_set().
+ */
+
+#ifndef MPSL_HFCLK_LATENCY_H__
+#define MPSL_HFCLK_LATENCY_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <stdint.h>
+
+/** Requester name of the measurement requests. Only starts made for it are
+ *  reported with mpsl_hfclk_latency_sample().
+ */
+extern const char mpsl_hfclk_latency_requester[];
+
+/** @brief Get the HFCLK latency to configure MPSL with.
+ *
+ * @param configured_us  Latency from devicetree or CONFIG_MPSL_HFCLK_LATENCY.
+ *
+ * @return The learned latency plus margin if one is known, otherwise
+ *         @p configured_us. Never less than @p configured_us minus
+ *         CONFIG_MPSL_HFCLK_LATENCY_MAX_REDUCTION.
+ */
+uint32_t mpsl_hfclk_latency_init(uint32_t configured_us);
+
+/** @brief Start the measurement bursts on the housekeeping queue. */
+void mpsl_hfclk_latency_measure_start(void);
+
+/** @brief Report a measured HFXO startup time.
+ *
+ * Called from the HFCLK_STARTED callback when a request for
+ * mpsl_hfclk_latency_requester started the crystal from off. ISR safe.
+ *
+ * @param latency_us  Time from request to HFCLK_STARTED.
+ */
+void mpsl_hfclk_latency_sample(uint32_t latency_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPSL_HFCLK_LATENCY_H__ */
@@ -4,6 +4,7 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <string.h>
 #include <zephyr/init.h>
 #include <zephyr/irq.h>
 #include <zephyr/kernel.h>
@@ -15,6 +16,16 @@
 #include <mpsl/mpsl_assert.h>
 #include <mpsl/mpsl_work.h>
 #include "multithreading_lock.h"
+#include "mpsl_work_stats.h"
+#if IS_ENABLED(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+#include "mpsl_hfclk_latency.h"
+#endif
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION)
+#include <mpsl/mpsl_radio_notif.h>
+#endif
+#if IS_ENABLED(CONFIG_MPSL_CALIBRATION_ADAPTIVE)
+#include "mpsl_calibration_sched.h"
+#endif
 #include <nrfx.h>
 #if defined(NRF_TRUSTZONE_NONSECURE)
 #include "tfm_platform_api.h"
@@ -181,7 +192,20 @@ static struct k_work mpsl_low_prio_work;
 struct k_work_q mpsl_work_q;
 static K_THREAD_STACK_DEFINE(mpsl_work_stack, CONFIG_MPSL_WORK_STACK_SIZE);
 
-/* NCS-specific option for flash sync - not available in vanilla Zephyr */
+#if IS_ENABLED(CONFIG_MPSL_HOUSEKEEPING_WORK_Q)
+/* Housekeeping work must not delay mpsl_low_priority_process(). It still
+ * runs alongside other MPSL callers, so calls into MPSL or the controller
+ * from it take the multithreading lock.
+ */
+BUILD_ASSERT(CONFIG_MPSL_HOUSEKEEPING_THREAD_COOP_PRIO > CONFIG_MPSL_THREAD_COOP_PRIO,
+	     "MPSL housekeeping queue must have a lower priority than the MPSL work queue");
+
+struct k_work_q mpsl_housekeeping_work_q;
+static K_THREAD_STACK_DEFINE(mpsl_housekeeping_work_stack,
+			     CONFIG_MPSL_HOUSEKEEPING_WORK_STACK_SIZE);
+#endif /* CONFIG_MPSL_HOUSEKEEPING_WORK_Q */
+
+/* Session reserved for timeslot synchronized flash, see flash_sync_mpsl.c */
 #ifndef CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_TIMESLOT_SESSION_COUNT
 #define CONFIG_SOC_FLASH_NRF_RADIO_SYNC_MPSL_TIMESLOT_SESSION_COUNT 0
 #endif
@@ -199,8 +223,60 @@ BUILD_ASSERT(MPSL_TIMESLOT_SESSION_COUNT <= MPSL_TIMESLOT_CONTEXT_COUNT_MAX,
 static uint8_t __aligned(4) timeslot_context[TIMESLOT_MEM_SIZE];
 #endif
 
+#if IS_ENABLED(CONFIG_MPSL_LOW_PRIO_LATENCY_STATS)
+static atomic_t low_prio_irq_pending;
+static uint32_t low_prio_irq_cycles;
+static struct mpsl_low_prio_latency low_prio_latency;
+
+static void low_prio_latency_irq_mark(void)
+{
+	/* Only the first IRQ of a batch is measured; later ones are
+	 * coalesced into the already pending work item.
+	 */
+	if (atomic_cas(&low_prio_irq_pending, 0, 1)) {
+		low_prio_irq_cycles = k_cycle_get_32();
+	}
+}
+
+static void low_prio_latency_record(void)
+{
+	uint32_t now = k_cycle_get_32();
+
+	if (!atomic_get(&low_prio_irq_pending)) {
+		return;
+	}
+
+	uint32_t delay_us = k_cyc_to_us_floor32(now - low_prio_irq_cycles);
+
+	atomic_clear(&low_prio_irq_pending);
+
+	unsigned int key = irq_lock();
+
+	low_prio_latency.count++;
+	low_prio_latency.total_us += delay_us;
+	low_prio_latency.max_us = MAX(low_prio_latency.max_us, delay_us);
+
+	irq_unlock(key);
+}
+
+void mpsl_low_prio_latency_get(struct mpsl_low_prio_latency *stats, bool reset)
+{
+	unsigned int key = irq_lock();
+
+	*stats = low_prio_latency;
+	if (reset) {
+		memset(&low_prio_latency, 0, sizeof(low_prio_latency));
+	}
+
+	irq_unlock(key);
+}
+#endif /* CONFIG_MPSL_LOW_PRIO_LATENCY_STATS */
+
 static void mpsl_low_prio_irq_handler(const void *arg)
 {
+#if IS_ENABLED(CONFIG_MPSL_LOW_PRIO_LATENCY_STATS)
+	low_prio_latency_irq_mark();
+#endif
 	mpsl_work_submit(&mpsl_low_prio_work);
 }
 
@@ -209,6 +285,11 @@ static void mpsl_low_prio_work_handler(struct k_work *item)
 	ARG_UNUSED(item);
 
 	int errcode;
+	uint32_t stats_start = mpsl_work_stats_begin();
+
+#if IS_ENABLED(CONFIG_MPSL_LOW_PRIO_LATENCY_STATS)
+	low_prio_latency_record();
+#endif
 
 	errcode = MULTITHREADING_LOCK_ACQUIRE();
 	__ASSERT_NO_MSG(errcode == 0);
@@ -220,14 +301,26 @@ static void mpsl_low_prio_work_handler(struct k_work *item)
 #endif
 
 	MULTITHREADING_LOCK_RELEASE();
+
+	mpsl_work_stats_end(MPSL_WORK_STATS_LOW_PRIO, stats_start);
 }
 
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION_STATS)
+#define MPSL_ISR_STATS_BEGIN() uint32_t isr_start = k_cycle_get_32()
+#define MPSL_ISR_STATS_END() mpsl_radio_notif_isr_account(k_cycle_get_32() - isr_start)
+#else
+#define MPSL_ISR_STATS_BEGIN()
+#define MPSL_ISR_STATS_END()
+#endif /* CONFIG_MPSL_RADIO_NOTIFICATION_STATS */
+
 #if IS_ENABLED(CONFIG_MPSL_DYNAMIC_INTERRUPTS)
 static void mpsl_timer0_isr_wrapper(const void *args)
 {
 	ARG_UNUSED(args);
 
+	MPSL_ISR_STATS_BEGIN();
 	MPSL_IRQ_TIMER0_Handler();
+	MPSL_ISR_STATS_END();
 }
 
 static void mpsl_rtc0_isr_wrapper(const void *args)
@@ -239,14 +332,18 @@ static void mpsl_rtc0_isr_wrapper(const void *args)
 		rtc_pretick_rtc0_isr_hook();
 	}
 
+	MPSL_ISR_STATS_BEGIN();
 	MPSL_IRQ_RTC0_Handler();
+	MPSL_ISR_STATS_END();
 }
 
 static void mpsl_radio_isr_wrapper(const void *args)
 {
 	ARG_UNUSED(args);
 
+	MPSL_ISR_STATS_BEGIN();
 	MPSL_IRQ_RADIO_Handler();
+	MPSL_ISR_STATS_END();
 }
 
 static void mpsl_lib_irq_disable(void)
@@ -275,7 +372,9 @@ static void mpsl_lib_irq_connect(void)
 #else /* !IS_ENABLED(CONFIG_MPSL_DYNAMIC_INTERRUPTS) */
 ISR_DIRECT_DECLARE(mpsl_timer0_isr_wrapper)
 {
+	MPSL_ISR_STATS_BEGIN();
 	MPSL_IRQ_TIMER0_Handler();
+	MPSL_ISR_STATS_END();
 
 	return 0;
 }
@@ -286,14 +385,18 @@ ISR_DIRECT_DECLARE(mpsl_rtc0_isr_wrapper)
 	    IS_ENABLED(CONFIG_SOC_NRF5340_CPUNET)) {
 		rtc_pretick_rtc0_isr_hook();
 	}
+	MPSL_ISR_STATS_BEGIN();
 	MPSL_IRQ_RTC0_Handler();
+	MPSL_ISR_STATS_END();
 
 	return 0;
 }
 
 ISR_DIRECT_DECLARE(mpsl_radio_isr_wrapper)
 {
+	MPSL_ISR_STATS_BEGIN();
 	MPSL_IRQ_RADIO_Handler();
+	MPSL_ISR_STATS_END();
 
 	return 0;
 }
@@ -346,18 +449,82 @@ static uint8_t m_config_clock_source_get(void)
 #if defined(CONFIG_MPSL_CALIBRATION_PERIOD)
 static atomic_t do_calibration;
 
+#if defined(CONFIG_MPSL_CALIBRATION_ADAPTIVE)
+/* MPSL calibrates unconditionally every MAX_SKIP + 1 calls and needs that
+ * to happen at least every 8 s for the 500 ppm RC accuracy it assumes.
+ * Kconfig only offers the adaptive period with MAX_SKIP = 0.
+ */
+BUILD_ASSERT(CONFIG_MPSL_CALIBRATION_PERIOD_MAX *
+		     (CONFIG_CLOCK_CONTROL_NRF_CALIBRATION_MAX_SKIP + 1) <= 8000,
+	     "MPSL_CALIBRATION_PERIOD_MAX exceeds the MPSL RC calibration interval");
+
+static struct mpsl_calibration_sched calibration_sched = {
+	.base_ms = CONFIG_MPSL_CALIBRATION_PERIOD,
+	.max_ms = CONFIG_MPSL_CALIBRATION_PERIOD_MAX,
+	/* Same threshold as MPSL, in 0.25 degree units */
+	.temp_diff = CONFIG_CLOCK_CONTROL_NRF_CALIBRATION_TEMP_DIFF,
+	.stable_readings = CONFIG_MPSL_CALIBRATION_ADAPTIVE_STABLE_COUNT,
+};
+
+static uint32_t calibration_sched_next(void)
+{
+	uint32_t prev_period_ms = calibration_sched.period_ms;
+	/* mpsl_calibration_timer_handle() may measure asynchronously, so its
+	 * result is not ours to read; take a reading through MPSL instead.
+	 */
+	uint32_t period_ms = mpsl_calibration_sched_next(&calibration_sched,
+							 mpsl_temperature_get());
+
+	if (period_ms != prev_period_ms) {
+		LOG_DBG("RC calibration period %u ms (%u wakeups/h)", period_ms,
+			(uint32_t)(MSEC_PER_SEC * 3600U / period_ms));
+	}
+
+	return period_ms;
+}
+#endif /* CONFIG_MPSL_CALIBRATION_ADAPTIVE */
+
+static void calibration_start(void)
+{
+#if defined(CONFIG_MPSL_CALIBRATION_ADAPTIVE)
+	mpsl_calibration_sched_reset(&calibration_sched, mpsl_temperature_get());
+#endif /* CONFIG_MPSL_CALIBRATION_ADAPTIVE */
+
+	atomic_set(&do_calibration, 1);
+	mpsl_housekeeping_work_schedule(&calibration_work,
+					K_MSEC(CONFIG_MPSL_CALIBRATION_PERIOD));
+}
+
 static void mpsl_calibration_work_handler(struct k_work *work)
 {
 	ARG_UNUSED(work);
 
+	uint32_t period_ms = CONFIG_MPSL_CALIBRATION_PERIOD;
+
 	if (!atomic_get(&do_calibration)) {
 		return;
 	}
 
+	uint32_t stats_start = mpsl_work_stats_begin();
+
+	/* May run on the housekeeping queue, which is not serialized with
+	 * other MPSL callers.
+	 */
+	int errcode = MULTITHREADING_LOCK_ACQUIRE();
+
+	__ASSERT_NO_MSG(errcode == 0);
+
 	mpsl_calibration_timer_handle();
 
-	mpsl_work_schedule(&calibration_work,
-			   K_MSEC(CONFIG_MPSL_CALIBRATION_PERIOD));
+#if defined(CONFIG_MPSL_CALIBRATION_ADAPTIVE)
+	period_ms = calibration_sched_next();
+#endif /* CONFIG_MPSL_CALIBRATION_ADAPTIVE */
+
+	MULTITHREADING_LOCK_RELEASE();
+
+	mpsl_work_stats_end(MPSL_WORK_STATS_CALIBRATION, stats_start);
+
+	mpsl_housekeeping_work_schedule(&calibration_work, K_MSEC(period_ms));
 }
 #endif /* CONFIG_MPSL_CALIBRATION_PERIOD */
 
@@ -388,9 +555,14 @@ static int32_t mpsl_lib_init_internal(void)
 		    "MPSL requires clock calibration to be enabled when RC is used as LFCLK");
 
 	/* clock_cfg.rc_ctiv is given in 1/4 seconds units.
-	 * CONFIG_MPSL_CALIBRATION_PERIOD is given in ms.
+	 * CONFIG_MPSL_CALIBRATION_PERIOD is given in ms. With the adaptive
+	 * period MPSL is told the longest interval it may see.
 	 */
+#if defined(CONFIG_MPSL_CALIBRATION_ADAPTIVE)
+	clock_cfg.rc_ctiv = (CONFIG_MPSL_CALIBRATION_PERIOD_MAX * 4 / 1000);
+#else
 	clock_cfg.rc_ctiv = (CONFIG_MPSL_CALIBRATION_PERIOD * 4 / 1000);
+#endif
 	clock_cfg.rc_temp_ctiv = CONFIG_CLOCK_CONTROL_NRF_CALIBRATION_MAX_SKIP + 1;
 	BUILD_ASSERT(CONFIG_CLOCK_CONTROL_NRF_CALIBRATION_TEMP_DIFF == 2,
 		     "MPSL always uses a temperature diff threshold of 0.5 degrees");
@@ -432,10 +604,14 @@ static int32_t mpsl_lib_init_internal(void)
 
 #if !defined(CONFIG_MPSL_USE_EXTERNAL_CLOCK_CONTROL)
 #if defined(CONFIG_CLOCK_CONTROL_NRF) && DT_NODE_EXISTS(DT_NODELABEL(hfxo))
-	mpsl_clock_hfclk_latency_set(z_nrf_clock_bt_ctlr_hf_get_startup_time_us());
+	uint32_t hfclk_latency_us = z_nrf_clock_bt_ctlr_hf_get_startup_time_us();
 #else
-	mpsl_clock_hfclk_latency_set(CONFIG_MPSL_HFCLK_LATENCY);
+	uint32_t hfclk_latency_us = CONFIG_MPSL_HFCLK_LATENCY;
 #endif /* CONFIG_CLOCK_CONTROL_NRF && DT_NODE_EXISTS(DT_NODELABEL(hfxo)) */
+#if defined(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+	hfclk_latency_us = mpsl_hfclk_latency_init(hfclk_latency_us);
+#endif /* CONFIG_MPSL_HFCLK_LATENCY_MEASURE */
+	mpsl_clock_hfclk_latency_set(hfclk_latency_us);
 #endif /* !CONFIG_MPSL_USE_EXTERNAL_CLOCK_CONTROL */
 	if (IS_ENABLED(CONFIG_SOC_NRF_FORCE_CONSTLAT) &&
 		!IS_ENABLED(CONFIG_SOC_COMPATIBLE_NRF54LX)) {
@@ -449,6 +625,12 @@ static int32_t mpsl_lib_init_internal(void)
 		return err;
 	}
 #endif /* MPSL_TIMESLOT_SESSION_COUNT > 0 */
+#if defined(CONFIG_MPSL_RADIO_NOTIFICATION)
+	err = mpsl_radio_notif_init();
+	if (err) {
+		return err;
+	}
+#endif /* CONFIG_MPSL_RADIO_NOTIFICATION */
 #if defined(NRF_TRUSTZONE_NONSECURE)
 	/* Temporary fix in order to get mpsl to work well when
 	 *  compiling for nrf54l15dk/nrf54l15/cpuapp/ns
@@ -510,15 +692,24 @@ static int mpsl_low_prio_init(void)
 	k_thread_name_set(&mpsl_work_q.thread, "MPSL Work");
 	k_work_init(&mpsl_low_prio_work, mpsl_low_prio_work_handler);
 
+#if IS_ENABLED(CONFIG_MPSL_HOUSEKEEPING_WORK_Q)
+	k_work_queue_start(&mpsl_housekeeping_work_q, mpsl_housekeeping_work_stack,
+			   K_THREAD_STACK_SIZEOF(mpsl_housekeeping_work_stack),
+			   K_PRIO_COOP(CONFIG_MPSL_HOUSEKEEPING_THREAD_COOP_PRIO), NULL);
+	k_thread_name_set(&mpsl_housekeeping_work_q.thread, "MPSL Housekeeping");
+#endif /* CONFIG_MPSL_HOUSEKEEPING_WORK_Q */
+
 	IRQ_CONNECT(CONFIG_MPSL_LOW_PRIO_IRQN, MPSL_LOW_PRIO,
 		    mpsl_low_prio_irq_handler, NULL, 0);
 
 #if defined(CONFIG_MPSL_CALIBRATION_PERIOD)
-	atomic_set(&do_calibration, 1);
-	mpsl_work_schedule(&calibration_work,
-			   K_MSEC(CONFIG_MPSL_CALIBRATION_PERIOD));
+	calibration_start();
 #endif /* CONFIG_MPSL_CALIBRATION_PERIOD */
 
+#if defined(CONFIG_MPSL_HFCLK_LATENCY_MEASURE)
+	mpsl_hfclk_latency_measure_start();
+#endif /* CONFIG_MPSL_HFCLK_LATENCY_MEASURE */
+
 	return 0;
 }
 
@@ -535,9 +726,7 @@ int32_t mpsl_lib_init(void)
 	mpsl_lib_irq_connect();
 
 #if defined(CONFIG_MPSL_CALIBRATION_PERIOD)
-	atomic_set(&do_calibration, 1);
-	mpsl_work_schedule(&calibration_work,
-			   K_MSEC(CONFIG_MPSL_CALIBRATION_PERIOD));
+	calibration_start();
 #endif /* CONFIG_MPSL_CALIBRATION_PERIOD */
 
 	return 0;
@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/irq.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/shell/shell.h>
+#include <mpsl_radio_notification.h>
+
+#include <mpsl/mpsl_radio_notif.h>
+
+LOG_MODULE_REGISTER(mpsl_radio_notif, CONFIG_MPSL_LOG_LEVEL);
+
+#if defined(CONFIG_MPSL_RADIO_NOTIFICATION_DISTANCE_420US)
+#define DISTANCE MPSL_RADIO_NOTIFICATION_DISTANCE_420US
+#elif defined(CONFIG_MPSL_RADIO_NOTIFICATION_DISTANCE_800US)
+#define DISTANCE MPSL_RADIO_NOTIFICATION_DISTANCE_800US
+#elif defined(CONFIG_MPSL_RADIO_NOTIFICATION_DISTANCE_1740US)
+#define DISTANCE MPSL_RADIO_NOTIFICATION_DISTANCE_1740US
+#else
+#define DISTANCE MPSL_RADIO_NOTIFICATION_DISTANCE_2680US
+#endif
+
+#define MAX_ACTIVE_CYCLES k_ms_to_cyc_ceil32(CONFIG_MPSL_RADIO_NOTIFICATION_MAX_ACTIVE_MS)
+
+BUILD_ASSERT(CONFIG_MPSL_RADIO_NOTIFICATION_IRQN != CONFIG_MPSL_LOW_PRIO_IRQN,
+	     "Radio notification and MPSL low priority processing need separate IRQs");
+
+static sys_slist_t listeners = SYS_SLIST_STATIC_INIT(&listeners);
+
+static struct k_spinlock lock;
+/* With notifications on both edges the same IRQ is pended before and
+ * after radio activity, so the edge is tracked here.
+ */
+static bool radio_active;
+/* Time of the last edge, to catch edges lost by merged IRQs */
+static uint32_t last_edge_cycles;
+static sys_slist_t deferred_work = SYS_SLIST_STATIC_INIT(&deferred_work);
+
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION_STATS)
+/* Only written by the MPSL high priority ISRs, which do not nest */
+static volatile uint32_t isr_cycles;
+static struct mpsl_radio_notif_stats stats;
+/* Cleared from the shell to measure the same work without alignment */
+static bool align_enabled = true;
+#define STATS_INC(_field)                                                                          \
+	do {                                                                                       \
+		stats._field++;                                                                    \
+	} while (0)
+#else
+#define align_enabled true
+#define STATS_INC(_field)
+#endif /* CONFIG_MPSL_RADIO_NOTIFICATION_STATS */
+
+static void radio_notif_isr(const void *arg)
+{
+	struct mpsl_radio_notif_listener *listener;
+	struct mpsl_radio_idle_work *idle_work, *tmp;
+	sys_slist_t ready;
+	bool active;
+
+	ARG_UNUSED(arg);
+
+	sys_slist_init(&ready);
+
+	uint32_t now = k_cycle_get_32();
+
+	K_SPINLOCK(&lock) {
+		/* If both edges of a short event are pended before the ISR
+		 * runs, one IRQ is seen for two edges and the parity flips.
+		 * Radio activity never lasts this long, so an edge this late
+		 * after an "active" one starts the next event.
+		 */
+		if (radio_active && now - last_edge_cycles > MAX_ACTIVE_CYCLES) {
+			STATS_INC(resync);
+		} else {
+			radio_active = !radio_active;
+		}
+		last_edge_cycles = now;
+		active = radio_active;
+
+		if (active) {
+			STATS_INC(active);
+		} else {
+			ready = deferred_work;
+			sys_slist_init(&deferred_work);
+		}
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER_SAFE(&ready, idle_work, tmp, node) {
+		idle_work->deferred = false;
+		(void)k_work_submit_to_queue(idle_work->queue, &idle_work->work);
+	}
+
+	SYS_SLIST_FOR_EACH_CONTAINER(&listeners, listener, node) {
+		if (active && listener->active_soon) {
+			listener->active_soon();
+		} else if (!active && listener->idle) {
+			listener->idle();
+		}
+	}
+}
+
+void mpsl_radio_notif_listener_add(struct mpsl_radio_notif_listener *listener)
+{
+	K_SPINLOCK(&lock) {
+		sys_slist_append(&listeners, &listener->node);
+	}
+}
+
+bool mpsl_radio_notif_is_idle(void)
+{
+	return !radio_active;
+}
+
+static void idle_work_handler(struct k_work *work)
+{
+	struct mpsl_radio_idle_work *idle_work =
+		CONTAINER_OF(work, struct mpsl_radio_idle_work, work);
+
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION_STATS)
+	uint32_t isr_start = isr_cycles;
+	uint32_t start = k_cycle_get_32();
+#endif
+
+	idle_work->handler(work);
+
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION_STATS)
+	uint32_t isr = isr_cycles - isr_start;
+	uint32_t total = k_cycle_get_32() - start;
+
+	K_SPINLOCK(&lock) {
+		stats.runs++;
+		stats.preempted += isr ? 1 : 0;
+		stats.work_us += k_cyc_to_us_floor32(total);
+		stats.isr_us += k_cyc_to_us_floor32(isr);
+	}
+#endif
+}
+
+void mpsl_radio_idle_work_init(struct mpsl_radio_idle_work *idle_work, k_work_handler_t handler)
+{
+	memset(idle_work, 0, sizeof(*idle_work));
+	k_work_init(&idle_work->work, idle_work_handler);
+	idle_work->handler = handler;
+}
+
+int mpsl_radio_idle_work_submit(struct mpsl_radio_idle_work *idle_work, struct k_work_q *queue)
+{
+	int ret = 0;
+	bool submit = false;
+
+	idle_work->queue = queue ? queue : &k_sys_work_q;
+
+	K_SPINLOCK(&lock) {
+		if (idle_work->deferred) {
+			ret = 1;
+		} else if (radio_active && align_enabled) {
+			idle_work->deferred = true;
+			sys_slist_append(&deferred_work, &idle_work->node);
+			STATS_INC(deferred);
+		} else {
+			submit = true;
+			STATS_INC(immediate);
+		}
+	}
+
+	if (submit) {
+		ret = k_work_submit_to_queue(idle_work->queue, &idle_work->work);
+		ret = (ret < 0) ? ret : 0;
+	}
+
+	return ret;
+}
+
+int mpsl_radio_notif_init(void)
+{
+	int err;
+
+	radio_active = false;
+
+	IRQ_CONNECT(CONFIG_MPSL_RADIO_NOTIFICATION_IRQN, CONFIG_MPSL_RADIO_NOTIFICATION_IRQ_PRIO,
+		    radio_notif_isr, NULL, 0);
+
+	err = mpsl_radio_notification_cfg_set(MPSL_RADIO_NOTIFICATION_TYPE_INT_ON_BOTH, DISTANCE,
+					      CONFIG_MPSL_RADIO_NOTIFICATION_IRQN);
+	if (err) {
+		LOG_ERR("Radio notification setup failed (%d)", err);
+		return err;
+	}
+
+	irq_enable(CONFIG_MPSL_RADIO_NOTIFICATION_IRQN);
+
+	return 0;
+}
+
+#if IS_ENABLED(CONFIG_MPSL_RADIO_NOTIFICATION_STATS)
+void mpsl_radio_notif_isr_account(uint32_t cycles)
+{
+	isr_cycles += cycles;
+}
+
+void mpsl_radio_notif_stats_get(struct mpsl_radio_notif_stats *out, bool reset)
+{
+	K_SPINLOCK(&lock) {
+		*out = stats;
+		if (reset) {
+			memset(&stats, 0, sizeof(stats));
+		}
+	}
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_radio(const struct shell *sh, size_t argc, char **argv)
+{
+	struct mpsl_radio_notif_stats snapshot;
+
+	mpsl_radio_notif_stats_get(&snapshot, false);
+
+	/* ISR share of idle work time in hundredths of a percent */
+	uint32_t share = snapshot.work_us ? snapshot.isr_us * 10000 / snapshot.work_us : 0;
+
+	shell_print(sh, "Alignment %s, radio %s, %u active notifications, %u resynced",
+		    align_enabled ? "on" : "off", radio_active ? "active" : "idle",
+		    snapshot.active, snapshot.resync);
+	shell_print(sh, "Idle work: %u immediate, %u deferred, %u runs", snapshot.immediate,
+		    snapshot.deferred, snapshot.runs);
+	shell_print(sh, "Preempted by MPSL ISRs: %u runs, %llu of %llu us (%u.%02u%%)",
+		    snapshot.preempted, snapshot.isr_us, snapshot.work_us, share / 100,
+		    share % 100);
+
+	return 0;
+}
+
+static int cmd_radio_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	struct mpsl_radio_notif_stats snapshot;
+
+	mpsl_radio_notif_stats_get(&snapshot, true);
+	shell_print(sh, "Radio idle work statistics reset");
+
+	return 0;
+}
+
+static int cmd_radio_align(const struct shell *sh, size_t argc, char **argv)
+{
+	if (strcmp(argv[1], "on") == 0) {
+		align_enabled = true;
+	} else if (strcmp(argv[1], "off") == 0) {
+		align_enabled = false;
+	} else {
+		shell_error(sh, "Expected on or off");
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_mpsl_radio,
+	SHELL_CMD_ARG(align, NULL, "Hold idle work until the radio is idle <on|off>",
+		      cmd_radio_align, 2, 0),
+	SHELL_CMD(reset, NULL, "Reset idle work statistics", cmd_radio_reset),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((mpsl), radio, &sub_mpsl_radio,
+		 "Show radio idle work statistics", cmd_radio, 1, 0);
+#endif /* CONFIG_SHELL */
+#endif /* CONFIG_MPSL_RADIO_NOTIFICATION_STATS */
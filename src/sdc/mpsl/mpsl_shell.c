@@ -0,0 +1,13 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/shell/shell.h>
+
+/* Root "mpsl" command. Diagnostics add their subcommands with
+ * SHELL_SUBCMD_ADD((mpsl), ...).
+ */
+SHELL_SUBCMD_SET_CREATE(sub_mpsl, (mpsl));
+SHELL_CMD_REGISTER(mpsl, &sub_mpsl, "MPSL diagnostics", NULL);
@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <mpsl/mpsl_work.h>
+
+#include "mpsl_work_stats.h"
+
+struct handler_stats {
+	uint32_t runs;
+	uint32_t max_cycles;
+	uint64_t total_cycles;
+};
+
+static struct handler_stats stats[MPSL_WORK_STATS_HANDLER_COUNT];
+static int64_t stats_reset_uptime;
+
+static const char *const handler_names[MPSL_WORK_STATS_HANDLER_COUNT] = {
+	[MPSL_WORK_STATS_LOW_PRIO] = "low_prio",
+	[MPSL_WORK_STATS_HCI_RX] = "hci_rx",
+	[MPSL_WORK_STATS_CALIBRATION] = "calibration",
+};
+
+void mpsl_work_stats_end(enum mpsl_work_stats_handler handler, uint32_t start)
+{
+	uint32_t cycles = k_cycle_get_32() - start;
+
+	__ASSERT_NO_MSG(handler < MPSL_WORK_STATS_HANDLER_COUNT);
+
+	/* Handlers run on cooperative threads; the lock only guards against
+	 * a concurrent shell reset.
+	 */
+	unsigned int key = irq_lock();
+
+	stats[handler].runs++;
+	stats[handler].total_cycles += cycles;
+	stats[handler].max_cycles = MAX(stats[handler].max_cycles, cycles);
+
+	irq_unlock(key);
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+
+static void print_stack(const struct shell *sh, const char *name, const struct k_thread *thread)
+{
+	size_t unused;
+	int err = k_thread_stack_space_get(thread, &unused);
+
+	if (err) {
+		shell_print(sh, "%-18s stack: unavailable (%d)", name, err);
+		return;
+	}
+
+	size_t size = thread->stack_info.size;
+
+	shell_print(sh, "%-18s stack: %zu / %zu bytes used (%zu unused)",
+		    name, size - unused, size, unused);
+}
+
+static int cmd_stats(const struct shell *sh, size_t argc, char **argv)
+{
+	struct handler_stats snapshot[MPSL_WORK_STATS_HANDLER_COUNT];
+	unsigned int key = irq_lock();
+
+	memcpy(snapshot, stats, sizeof(snapshot));
+
+	irq_unlock(key);
+
+	int64_t elapsed_ms = MAX(k_uptime_get() - stats_reset_uptime, 1);
+
+	print_stack(sh, "MPSL Work", &mpsl_work_q.thread);
+#if IS_ENABLED(CONFIG_MPSL_HOUSEKEEPING_WORK_Q)
+	print_stack(sh, "MPSL Housekeeping", &mpsl_housekeeping_work_q.thread);
+#endif
+
+	shell_print(sh, "Handler runs since %lld ms ago:", elapsed_ms);
+
+	for (size_t i = 0; i < MPSL_WORK_STATS_HANDLER_COUNT; i++) {
+		uint64_t total_us = k_cyc_to_us_floor64(snapshot[i].total_cycles);
+		uint32_t avg_us = snapshot[i].runs ? total_us / snapshot[i].runs : 0;
+		/* CPU share in hundredths of a percent */
+		uint32_t share = total_us * 10 / elapsed_ms;
+
+		uint32_t per_hour = (uint64_t)snapshot[i].runs * 3600U * MSEC_PER_SEC / elapsed_ms;
+
+		shell_print(sh, "  %-12s runs=%u (%u/h) total=%llu us avg=%u us max=%u us "
+			    "cpu=%u.%02u%%",
+			    handler_names[i], snapshot[i].runs, per_hour, total_us, avg_us,
+			    k_cyc_to_us_floor32(snapshot[i].max_cycles),
+			    share / 100, share % 100);
+	}
+
+#if IS_ENABLED(CONFIG_MPSL_LOW_PRIO_LATENCY_STATS)
+	struct mpsl_low_prio_latency latency;
+
+	mpsl_low_prio_latency_get(&latency, false);
+	shell_print(sh, "Low prio queueing delay: n=%u avg=%llu us max=%u us",
+		    latency.count, latency.count ? latency.total_us / latency.count : 0,
+		    latency.max_us);
+#endif
+
+	return 0;
+}
+
+static int cmd_stats_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	unsigned int key = irq_lock();
+
+	memset(stats, 0, sizeof(stats));
+	stats_reset_uptime = k_uptime_get();
+
+	irq_unlock(key);
+
+#if IS_ENABLED(CONFIG_MPSL_LOW_PRIO_LATENCY_STATS)
+	struct mpsl_low_prio_latency latency;
+
+	mpsl_low_prio_latency_get(&latency, true);
+#endif
+
+	shell_print(sh, "MPSL work statistics reset");
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_mpsl_stats,
+	SHELL_CMD(reset, NULL, "Reset handler statistics", cmd_stats_reset),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((mpsl), stats, &sub_mpsl_stats, "Show MPSL work queue statistics",
+		 cmd_stats, 1, 0);
+
+#endif /* CONFIG_SHELL */
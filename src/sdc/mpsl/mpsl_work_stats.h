@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file mpsl_work_stats.h
+ *
+ * @brief Run time and stack usage statistics for the MPSL work queue handlers.
+ */
+
+#ifndef MPSL_WORK_STATS_H__
+#define MPSL_WORK_STATS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include <zephyr/kernel.h>
+
+/** Work handlers tracked by the statistics. */
+enum mpsl_work_stats_handler {
+	MPSL_WORK_STATS_LOW_PRIO,
+	MPSL_WORK_STATS_HCI_RX,
+	MPSL_WORK_STATS_CALIBRATION,
+	MPSL_WORK_STATS_HANDLER_COUNT,
+};
+
+#if IS_ENABLED(CONFIG_MPSL_WORK_STATS)
+
+/** @brief Mark the start of a work handler run.
+ *
+ * @return Start timestamp to pass to mpsl_work_stats_end().
+ */
+static inline uint32_t mpsl_work_stats_begin(void)
+{
+	return k_cycle_get_32();
+}
+
+/** @brief Account a finished work handler run.
+ *
+ * @param handler  Handler that ran.
+ * @param start    Value returned by mpsl_work_stats_begin().
+ */
+void mpsl_work_stats_end(enum mpsl_work_stats_handler handler, uint32_t start);
+
+#else
+
+static inline uint32_t mpsl_work_stats_begin(void)
+{
+	return 0;
+}
+
+static inline void mpsl_work_stats_end(enum mpsl_work_stats_handler handler, uint32_t start)
+{
+	ARG_UNUSED(handler);
+	ARG_UNUSED(start);
+}
+
+#endif /* CONFIG_MPSL_WORK_STATS */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPSL_WORK_STATS_H__ */
@@ -4,16 +4,186 @@
  * SPDX-License-Identifier: LicenseRef-Nordic-5-Clause
  */
 
+#include <string.h>
+#include <zephyr/shell/shell.h>
+
 #include "multithreading_lock.h"
 
 static K_MUTEX_DEFINE(mpsl_lock);
 
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_PRIO_CEILING)
+static int owner_prio;
+#endif
+
+/* Recursion depth, only modified by the lock owner. */
+static uint32_t lock_depth;
+
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_STATS)
+/* Guards the site table; failed acquisitions update it without the lock */
+static struct k_spinlock stats_lock;
+static struct multithreading_lock_site_stats sites[CONFIG_MULTITHREADING_LOCK_STATS_SITES];
+/* Only accessed by the lock owner */
+static struct multithreading_lock_site_stats *owner_site;
+static uint32_t owner_acquired_cycles;
+
+/* Called with stats_lock held */
+static struct multithreading_lock_site_stats *site_get(const char *name)
+{
+	if (name == NULL) {
+		name = "unknown";
+	}
+
+	for (size_t i = 0; i < ARRAY_SIZE(sites); i++) {
+		if (sites[i].name == name || sites[i].name == NULL) {
+			sites[i].name = name;
+			return &sites[i];
+		}
+	}
+
+	return NULL;
+}
+#endif /* CONFIG_MULTITHREADING_LOCK_STATS */
+
+static int lock_take(k_timeout_t timeout, bool *contended)
+{
+	int err = k_mutex_lock(&mpsl_lock, K_NO_WAIT);
+
+	*contended = (err != 0);
+	if (err && !K_TIMEOUT_EQ(timeout, K_NO_WAIT)) {
+		err = k_mutex_lock(&mpsl_lock, timeout);
+	}
+
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_PRIO_CEILING)
+	if (!err && lock_depth == 0) {
+		int ceiling = K_PRIO_COOP(CONFIG_MULTITHREADING_LOCK_PRIO_CEILING_PRIO);
+
+		owner_prio = k_thread_priority_get(k_current_get());
+		if (owner_prio > ceiling) {
+			k_thread_priority_set(k_current_get(), ceiling);
+		}
+	}
+#endif
+
+	return err;
+}
+
+static void lock_give(void)
+{
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_PRIO_CEILING)
+	if (lock_depth == 0) {
+		k_thread_priority_set(k_current_get(), owner_prio);
+	}
+#endif
+	k_mutex_unlock(&mpsl_lock);
+}
+
+int multithreading_lock_acquire_from(k_timeout_t timeout, const char *site_name)
+{
+	bool contended;
+
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_STATS)
+	uint32_t start = k_cycle_get_32();
+#else
+	ARG_UNUSED(site_name);
+#endif
+
+	int err = lock_take(timeout, &contended);
+
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_STATS)
+	uint32_t wait_us = k_cyc_to_us_floor32(k_cycle_get_32() - start);
+	struct multithreading_lock_site_stats *site;
+
+	K_SPINLOCK(&stats_lock) {
+		site = site_get(site_name);
+		if (site != NULL) {
+			site->acquisitions++;
+			site->contended += contended ? 1 : 0;
+			site->failed += err ? 1 : 0;
+			site->max_wait_us = MAX(site->max_wait_us, wait_us);
+		}
+	}
+
+	if (!err && lock_depth == 0) {
+		owner_site = site;
+		owner_acquired_cycles = k_cycle_get_32();
+	}
+#endif /* CONFIG_MULTITHREADING_LOCK_STATS */
+
+	if (!err) {
+		lock_depth++;
+	}
+
+	return err;
+}
+
 int multithreading_lock_acquire(k_timeout_t timeout)
 {
-	return k_mutex_lock(&mpsl_lock, timeout);
+	return multithreading_lock_acquire_from(timeout, NULL);
 }
 
 void multithreading_lock_release(void)
 {
-	k_mutex_unlock(&mpsl_lock);
+	__ASSERT_NO_MSG(lock_depth > 0);
+
+	lock_depth--;
+
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_STATS)
+	if (lock_depth == 0 && owner_site != NULL) {
+		uint32_t hold_us = k_cyc_to_us_floor32(k_cycle_get_32() - owner_acquired_cycles);
+
+		K_SPINLOCK(&stats_lock) {
+			owner_site->max_hold_us = MAX(owner_site->max_hold_us, hold_us);
+		}
+		owner_site = NULL;
+	}
+#endif /* CONFIG_MULTITHREADING_LOCK_STATS */
+
+	lock_give();
+}
+
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_STATS)
+size_t multithreading_lock_stats_get(struct multithreading_lock_site_stats *stats, size_t max,
+				     bool reset)
+{
+	size_t count = 0;
+
+	K_SPINLOCK(&stats_lock) {
+		for (size_t i = 0; i < ARRAY_SIZE(sites) && sites[i].name != NULL; i++) {
+			if (count < max) {
+				stats[count++] = sites[i];
+			}
+			if (reset) {
+				const char *name = sites[i].name;
+
+				memset(&sites[i], 0, sizeof(sites[i]));
+				sites[i].name = name;
+			}
+		}
+	}
+
+	return count;
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int cmd_lock(const struct shell *sh, size_t argc, char **argv)
+{
+	struct multithreading_lock_site_stats stats[CONFIG_MULTITHREADING_LOCK_STATS_SITES];
+	bool reset = (argc > 1 && strcmp(argv[1], "reset") == 0);
+	size_t count = multithreading_lock_stats_get(stats, ARRAY_SIZE(stats), reset);
+
+	shell_print(sh, "%-28s %10s %10s %6s %10s %10s", "site", "acquired", "contended",
+		    "failed", "max wait", "max hold");
+
+	for (size_t i = 0; i < count; i++) {
+		shell_print(sh, "%-28s %10u %10u %6u %7u us %7u us", stats[i].name,
+			    stats[i].acquisitions, stats[i].contended, stats[i].failed,
+			    stats[i].max_wait_us, stats[i].max_hold_us);
+	}
+
+	return 0;
 }
+
+SHELL_SUBCMD_ADD((mpsl), lock, NULL, "Show MPSL lock contention per call site [reset]",
+		 cmd_lock, 1, 1);
+#endif /* CONFIG_SHELL */
+#endif /* CONFIG_MULTITHREADING_LOCK_STATS */
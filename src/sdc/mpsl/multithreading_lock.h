@@ -19,17 +19,24 @@ extern "C" {
 
 #include <zephyr/kernel.h>
 
+/** Call site name recorded by the lock statistics. */
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_STATS)
+#define MULTITHREADING_LOCK_SITE __func__
+#else
+#define MULTITHREADING_LOCK_SITE NULL
+#endif
+
 /** Macro for acquiring a lock */
 #define MULTITHREADING_LOCK_ACQUIRE() \
-	multithreading_lock_acquire(K_FOREVER)
+	multithreading_lock_acquire_from(K_FOREVER, MULTITHREADING_LOCK_SITE)
 
 /** Macro for acquiring a lock without waiting. */
 #define MULTITHREADING_LOCK_ACQUIRE_NO_WAIT() \
-	multithreading_lock_acquire(K_NO_WAIT)
+	multithreading_lock_acquire_from(K_NO_WAIT, MULTITHREADING_LOCK_SITE)
 
 /** Macro for acquiring a lock while waiting forever. */
 #define MULTITHREADING_LOCK_ACQUIRE_FOREVER_WAIT() \
-	multithreading_lock_acquire(K_FOREVER)
+	multithreading_lock_acquire_from(K_FOREVER, MULTITHREADING_LOCK_SITE)
 
 /** Macro for releasing a lock */
 #define MULTITHREADING_LOCK_RELEASE() multithreading_lock_release()
@@ -48,12 +55,55 @@ extern "C" {
  */
 int multithreading_lock_acquire(k_timeout_t timeout);
 
+/** @brief Try to take the lock on behalf of a named call site.
+ *
+ * Same as @ref multithreading_lock_acquire, but accounts the acquisition
+ * to @p site_name when CONFIG_MULTITHREADING_LOCK_STATS is enabled.
+ *
+ * @param[in] timeout     Timeout value for the locking API.
+ * @param[in] site_name   Call site name, compared by pointer. May be NULL.
+ *
+ * @retval 0              Success
+ * @retval -EBUSY         Returned without waiting.
+ * @retval -EAGAIN        Waiting period timed out.
+ */
+int multithreading_lock_acquire_from(k_timeout_t timeout, const char *site_name);
+
 /** @brief Unlock the lock.
  *
  * @note This API is must be called only after lock is obtained.
  */
 void multithreading_lock_release(void);
 
+#if IS_ENABLED(CONFIG_MULTITHREADING_LOCK_STATS)
+/** Lock usage statistics of one call site. */
+struct multithreading_lock_site_stats {
+	/** Call site name, NULL for an unused entry. */
+	const char *name;
+	/** Number of acquisition attempts. */
+	uint32_t acquisitions;
+	/** Attempts that found the lock already taken. */
+	uint32_t contended;
+	/** Attempts that returned without the lock. */
+	uint32_t failed;
+	/** Longest time spent waiting for the lock, in microseconds. */
+	uint32_t max_wait_us;
+	/** Longest time the lock was held, in microseconds. */
+	uint32_t max_hold_us;
+};
+
+/** @brief Copy the per call site lock statistics.
+ *
+ * @param[out] stats  Destination array.
+ * @param[in]  max    Number of entries in @p stats.
+ * @param[in]  reset  Clear the statistics after reading them.
+ *
+ * @return Number of entries written.
+ */
+size_t multithreading_lock_stats_get(struct multithreading_lock_site_stats *stats, size_t max,
+				     bool reset);
+#endif /* CONFIG_MULTITHREADING_LOCK_STATS */
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/logging/log.h>
+#include <zephyr/pm/policy.h>
+#include <zephyr/pm/state.h>
+#include <zephyr/shell/shell.h>
+#include <hal/nrf_rtc.h>
+#include <mpsl_pm.h>
+#if IS_ENABLED(CONFIG_MPSL_PM_STATS)
+#include <mpsl/mpsl_pm_stats.h>
+#endif
+
+#include "mpsl_pm_utils.h"
+
+LOG_MODULE_REGISTER(mpsl_pm_utils, CONFIG_MPSL_LOG_LEVEL);
+
+/* MPSL keeps its time in RTC0 at 32768 Hz. Zephyr's system timer runs on
+ * another RTC, so MPSL's absolute event time is converted through the
+ * distance from the current RTC0 count.
+ */
+#define RTC_FREQUENCY 32768
+#define RTC_COUNTER_MASK 0xFFFFFF
+
+/* Covers the conversion rounding and the time to register the event */
+#define EVENT_MARGIN_US 100
+
+static uint8_t prev_cnt_flag;
+static uint64_t prev_event_time_us;
+static bool event_registered;
+static struct pm_policy_event policy_event;
+
+#if IS_ENABLED(CONFIG_MPSL_PM_STATS)
+#define STATS_STATES 4
+/* Gap length buckets: below 1 ms, then doubling up to 256 ms and above */
+#define STATS_BUCKETS 10
+
+struct state_stats {
+	/* Gaps long enough for the state */
+	uint32_t gaps;
+	/* Time that can be spent in the state, exit latency excluded */
+	uint64_t residency_us;
+};
+
+/* Gaps while the application was in one state, see mpsl_pm_stats_tag_set().
+ * Unlike the per power state figures these need no devicetree states, so
+ * they are available on boards like the stock nRF52840 that have none.
+ */
+struct tag_stats {
+	const char *name;
+	uint32_t gaps;
+	uint64_t gap_us;
+	uint32_t buckets[STATS_BUCKETS];
+};
+
+static struct k_spinlock stats_lock;
+static uint32_t gaps;
+static uint64_t gap_us;
+static struct state_stats state_stats[STATS_STATES];
+static struct tag_stats tag_stats[CONFIG_MPSL_PM_STATS_TAGS];
+static uint8_t current_tag;
+static int64_t stats_since_ms;
+
+static uint8_t gap_bucket(uint32_t us)
+{
+	uint8_t bucket = 0;
+
+	for (uint32_t ms = us / 1000; ms > 0 && bucket < STATS_BUCKETS - 1; ms >>= 1) {
+		bucket++;
+	}
+
+	return bucket;
+}
+
+void mpsl_pm_stats_tag_set(uint8_t tag, const char *name)
+{
+	tag = MIN(tag, CONFIG_MPSL_PM_STATS_TAGS - 1);
+
+	K_SPINLOCK(&stats_lock) {
+		current_tag = tag;
+		tag_stats[tag].name = name;
+	}
+}
+
+static void stats_record_gap(uint32_t us)
+{
+	const struct pm_state_info *states;
+	uint8_t count = MIN(pm_state_cpu_get_all(0, &states), STATS_STATES);
+
+	K_SPINLOCK(&stats_lock) {
+		struct tag_stats *tag = &tag_stats[current_tag];
+
+		gaps++;
+		gap_us += us;
+		tag->gaps++;
+		tag->gap_us += us;
+		tag->buckets[gap_bucket(us)]++;
+
+		for (uint8_t i = 0; i < count; i++) {
+			if (us < states[i].min_residency_us + states[i].exit_latency_us) {
+				continue;
+			}
+
+			state_stats[i].gaps++;
+			state_stats[i].residency_us += us - states[i].exit_latency_us;
+		}
+	}
+}
+#else
+#define stats_record_gap(us)
+#endif /* CONFIG_MPSL_PM_STATS */
+
+static uint32_t event_distance_us(uint64_t event_time_abs_us)
+{
+	uint32_t event_rtc = (uint32_t)(event_time_abs_us * RTC_FREQUENCY / USEC_PER_SEC);
+	uint32_t distance = (event_rtc - nrf_rtc_counter_get(NRF_RTC0)) & RTC_COUNTER_MASK;
+
+	/* Already started */
+	if (distance > RTC_COUNTER_MASK / 2) {
+		return 0;
+	}
+
+	return (uint32_t)((uint64_t)distance * USEC_PER_SEC / RTC_FREQUENCY);
+}
+
+static void event_set(uint64_t event_time_abs_us)
+{
+	uint32_t distance_us = event_distance_us(event_time_abs_us);
+
+	if (event_time_abs_us != prev_event_time_us) {
+		prev_event_time_us = event_time_abs_us;
+		stats_record_gap(distance_us);
+	}
+
+	distance_us = distance_us > EVENT_MARGIN_US ? distance_us - EVENT_MARGIN_US : 0;
+
+	int64_t uptime_ticks = k_uptime_ticks() + k_us_to_ticks_floor64(distance_us);
+
+	if (event_registered) {
+		pm_policy_event_update(&policy_event, uptime_ticks);
+	} else {
+		pm_policy_event_register(&policy_event, uptime_ticks);
+		event_registered = true;
+	}
+}
+
+static void event_clear(void)
+{
+	if (event_registered) {
+		pm_policy_event_unregister(&policy_event);
+		event_registered = false;
+	}
+}
+
+void mpsl_pm_utils_work_handler(void)
+{
+	mpsl_pm_params_t params = {0};
+	bool valid = mpsl_pm_params_get(&params);
+
+	if (params.cnt_flag == prev_cnt_flag) {
+		return;
+	}
+
+	prev_cnt_flag = params.cnt_flag;
+
+	/* Updated by MPSL while being read; a new low priority run follows */
+	if (!valid) {
+		return;
+	}
+
+	switch (params.event_state) {
+	case MPSL_PM_EVENT_STATE_NO_EVENTS_LEFT:
+		event_clear();
+		break;
+	case MPSL_PM_EVENT_STATE_BEFORE_EVENT:
+		event_set(params.event_time_abs_us);
+		break;
+	case MPSL_PM_EVENT_STATE_IN_EVENT:
+		/* The event keeps the CPU busy; the policy need not know */
+		break;
+	default:
+		__ASSERT(false, "Unknown MPSL PM event state %d", params.event_state);
+		break;
+	}
+}
+
+int mpsl_pm_utils_init(void)
+{
+	mpsl_pm_params_t params = {0};
+
+	mpsl_pm_init();
+
+	event_registered = false;
+	prev_event_time_us = 0;
+	(void)mpsl_pm_params_get(&params);
+	prev_cnt_flag = params.cnt_flag;
+
+#if IS_ENABLED(CONFIG_MPSL_PM_STATS)
+	stats_since_ms = k_uptime_get();
+#endif
+
+	return 0;
+}
+
+int mpsl_pm_utils_uninit(void)
+{
+	mpsl_pm_uninit();
+	event_clear();
+
+	return 0;
+}
+
+#if IS_ENABLED(CONFIG_MPSL_PM_STATS) && IS_ENABLED(CONFIG_SHELL)
+static int cmd_pm(const struct shell *sh, size_t argc, char **argv)
+{
+	const struct pm_state_info *states;
+	uint8_t count = MIN(pm_state_cpu_get_all(0, &states), STATS_STATES);
+	struct state_stats snapshot[STATS_STATES];
+	struct tag_stats tags[CONFIG_MPSL_PM_STATS_TAGS];
+	uint32_t total_gaps;
+	uint64_t total_us;
+	int64_t elapsed_ms;
+
+	K_SPINLOCK(&stats_lock) {
+		memcpy(snapshot, state_stats, sizeof(snapshot));
+		memcpy(tags, tag_stats, sizeof(tags));
+		total_gaps = gaps;
+		total_us = gap_us;
+		elapsed_ms = MAX(k_uptime_get() - stats_since_ms, 1);
+	}
+
+	shell_print(sh, "Radio event gaps: %u, %llu us in %lld ms", total_gaps, total_us,
+		    elapsed_ms);
+
+	for (uint8_t t = 0; t < ARRAY_SIZE(tags); t++) {
+		if (tags[t].gaps == 0) {
+			continue;
+		}
+
+		shell_print(sh, "%-16s %u gaps, average %llu us", tags[t].name ? tags[t].name : "-",
+			    tags[t].gaps, tags[t].gap_us / tags[t].gaps);
+		shell_print(sh, "  <1ms:%u 1:%u 2:%u 4:%u 8:%u 16:%u 32:%u 64:%u 128:%u >=256:%u",
+			    tags[t].buckets[0], tags[t].buckets[1], tags[t].buckets[2],
+			    tags[t].buckets[3], tags[t].buckets[4], tags[t].buckets[5],
+			    tags[t].buckets[6], tags[t].buckets[7], tags[t].buckets[8],
+			    tags[t].buckets[9]);
+	}
+
+	if (count == 0) {
+		shell_print(sh, "No CPU power states in devicetree");
+		return 0;
+	}
+
+	for (uint8_t i = 0; i < count; i++) {
+		/* Share of uptime in hundredths of a percent */
+		uint32_t share = (uint32_t)(snapshot[i].residency_us * 10 / elapsed_ms);
+
+		shell_print(sh, "%-16s %u gaps, %llu us residency (%u.%02u%% of uptime)",
+			    pm_state_to_str(states[i].state), snapshot[i].gaps,
+			    snapshot[i].residency_us, share / 100, share % 100);
+	}
+
+	return 0;
+}
+
+static int cmd_pm_reset(const struct shell *sh, size_t argc, char **argv)
+{
+	K_SPINLOCK(&stats_lock) {
+		memset(state_stats, 0, sizeof(state_stats));
+		for (uint8_t t = 0; t < ARRAY_SIZE(tag_stats); t++) {
+			const char *name = tag_stats[t].name;
+
+			memset(&tag_stats[t], 0, sizeof(tag_stats[t]));
+			tag_stats[t].name = name;
+		}
+		gaps = 0;
+		gap_us = 0;
+		stats_since_ms = k_uptime_get();
+	}
+
+	shell_print(sh, "Power state statistics reset");
+
+	return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_mpsl_pm,
+	SHELL_CMD(reset, NULL, "Reset power state statistics", cmd_pm_reset),
+	SHELL_SUBCMD_SET_END
+);
+
+SHELL_SUBCMD_ADD((mpsl), pm, &sub_mpsl_pm,
+		 "Show idle residency available per power state", cmd_pm, 1, 0);
+#endif /* CONFIG_MPSL_PM_STATS && CONFIG_SHELL */
@@ -0,0 +1,43 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/**
+ * @file mpsl_pm_utils.h
+ *
+ * @brief Forward MPSL's next radio event to the Zephyr PM policy.
+ */
+
+#ifndef MPSL_PM_UTILS_H__
+#define MPSL_PM_UTILS_H__
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/** @brief Initialize MPSL PM and the policy event.
+ *
+ * @return Zero on success or (negative) error code otherwise.
+ */
+int mpsl_pm_utils_init(void);
+
+/** @brief Unregister the policy event.
+ *
+ * @return Zero on success or (negative) error code otherwise.
+ */
+int mpsl_pm_utils_uninit(void);
+
+/** @brief Update the policy event from the MPSL PM parameters.
+ *
+ * Called from MPSL low priority processing with the multithreading lock
+ * held.
+ */
+void mpsl_pm_utils_work_handler(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MPSL_PM_UTILS_H__ */
@@ -5,22 +5,62 @@
  */
 
 #include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
+#include <zephyr/devicetree.h>
 #include <zephyr/logging/log.h>
 LOG_MODULE_REGISTER(zmk_sdc_subrating, CONFIG_ZMK_LOG_LEVEL);
 
 #include <zephyr/bluetooth/bluetooth.h>
 #include <zephyr/bluetooth/conn.h>
+#include <zephyr/settings/settings.h>
+#include <zephyr/shell/shell.h>
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_PERIPHERAL_FAST_WAKE)
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/sys/byteorder.h>
+#include <sdc_hci_vs.h>
+#endif
+#if IS_ENABLED(CONFIG_MPSL_PM_STATS)
+#include <mpsl/mpsl_pm_stats.h>
+#endif
 
 #include <zmk/event_manager.h>
 #include <zmk/events/activity_state_changed.h>
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+#include <zmk/events/battery_state_changed.h>
+#endif
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_USB_POWER)
+#include <zmk/events/usb_conn_state_changed.h>
+#include <zmk/usb.h>
+#endif
+#include <zmk/events/position_state_changed.h>
+
+#include <zmk_sdc/subrating.h>
+
+#include "subrating_ladder.h"
 
 #if IS_ENABLED(CONFIG_BT_SUBRATING)
 
 #if IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
 
 #define SUBRATE_TIMEOUT         CONFIG_ZMK_BLE_SUBRATE_TIMEOUT
+
+/* Tiers come from a zmk,sdc-subrating-tiers devicetree node if there is
+ * one, otherwise from the Kconfig ACTIVE, IDLE and DORMANT options.
+ */
+#define TIERS_NODE    DT_INST(0, zmk_sdc_subrating_tiers)
+#define TIERS_FROM_DT DT_HAS_COMPAT_STATUS_OKAY(zmk_sdc_subrating_tiers)
+
+/* Host connection parameters can change with the tier or USB power */
+#define HOST_PARAMS_TIERED (IS_ENABLED(CONFIG_ZMK_BLE_HOST_CONN_PARAM_DORMANT) || TIERS_FROM_DT || \
+                            IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_USB_POWER_HOST))
+
+#if !TIERS_FROM_DT
+
 #define SUBRATE_DORMANT_DELAY_MS CONFIG_ZMK_BLE_SUBRATE_DORMANT_DELAY
+#define LINK_IDLE_TIMEOUT_MS     CONFIG_ZMK_BLE_SUBRATE_LINK_IDLE_TIMEOUT
 
 /* ACTIVE tier */
 #define SUBRATE_ACTIVE_MIN         CONFIG_ZMK_BLE_SUBRATE_ACTIVE_MIN
@@ -91,7 +131,22 @@ static const struct bt_conn_le_subrate_param dormant_params = {
     .supervision_timeout = SUBRATE_TIMEOUT,
 };
 
-#if IS_ENABLED(CONFIG_ZMK_BLE_HOST_CONN_PARAM_DORMANT)
+#endif /* !TIERS_FROM_DT */
+
+/*
+ * LL procedure budget: up to PROCEDURES_PER_MIN subrate or connection
+ * parameter procedures, refilled evenly over a minute. Requests over
+ * budget are deferred, not dropped.
+ */
+#define PROCEDURES_PER_MIN   CONFIG_ZMK_BLE_SUBRATE_PROCEDURES_PER_MIN
+#define PROCEDURE_REFILL_MS  (60000 / PROCEDURES_PER_MIN)
+#define MIN_DWELL_MS         CONFIG_ZMK_BLE_SUBRATE_MIN_DWELL
+
+#define PROCEDURE_BUDGET_INIT SUBRATE_BUDGET_INIT(PROCEDURES_PER_MIN, PROCEDURE_REFILL_MS)
+
+#if HOST_PARAMS_TIERED
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_HOST_CONN_PARAM_DORMANT) && !TIERS_FROM_DT
 
 /* Host connection parameters for dormant tier */
 #define HOST_DORMANT_INT_MIN    CONFIG_ZMK_BLE_HOST_CONN_DORMANT_INT_MIN
@@ -124,6 +179,8 @@ static const struct bt_le_conn_param host_dormant_params = {
     .timeout = HOST_DORMANT_TIMEOUT,
 };
 
+#endif /* CONFIG_ZMK_BLE_HOST_CONN_PARAM_DORMANT && !TIERS_FROM_DT */
+
 /* Normal host parameters (from ZMK defaults) */
 static const struct bt_le_conn_param host_active_params = {
     .interval_min = CONFIG_BT_PERIPHERAL_PREF_MIN_INT,
@@ -132,6 +189,16 @@ static const struct bt_le_conn_param host_active_params = {
     .timeout = CONFIG_BT_PERIPHERAL_PREF_TIMEOUT,
 };
 
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_USB_POWER_HOST)
+/* Fastest host parameters, while on USB power (7.5ms, no latency) */
+static const struct bt_le_conn_param host_usb_params = {
+    .interval_min = 6,
+    .interval_max = 6,
+    .latency = 0,
+    .timeout = CONFIG_BT_PERIPHERAL_PREF_TIMEOUT,
+};
+#endif
+
 static void apply_conn_param_to_host(struct bt_conn *conn, void *data) {
     const struct bt_le_conn_param *params = data;
     struct bt_conn_info info;
@@ -147,186 +214,1938 @@ static void apply_conn_param_to_host(struct bt_conn *conn, void *data) {
     }
 }
 
-#endif /* CONFIG_ZMK_BLE_HOST_CONN_PARAM_DORMANT */
+/* Host parameter changes are budgeted like split link procedures; only
+ * the latest target is kept while waiting. Changes for a key press skip
+ * the budget.
+ */
+static const struct bt_le_conn_param *host_params_target;
+static bool host_params_wake;
+static const struct bt_le_conn_param *host_params_applied = &host_active_params;
+static struct subrate_budget host_budget = PROCEDURE_BUDGET_INIT;
 
-static void dormant_timer_handler(struct k_work *work);
-static K_WORK_DELAYABLE_DEFINE(dormant_work, dormant_timer_handler);
+static void host_params_work_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(host_params_work, host_params_work_handler);
 
-enum subrate_tier { TIER_ACTIVE, TIER_IDLE, TIER_DORMANT };
-static enum subrate_tier current_tier = TIER_IDLE;
+static void host_params_work_handler(struct k_work *work) {
+    const struct bt_le_conn_param *params = host_params_target;
 
-static void apply_subrate_to_conn(struct bt_conn *conn, void *data) {
-    const struct bt_conn_le_subrate_param *params = data;
-    struct bt_conn_info info;
+    if (params == NULL || params == host_params_applied) {
+        return;
+    }
 
-    bt_conn_get_info(conn, &info);
+    uint32_t wait_ms = host_params_wake ? 0 : subrate_budget_take(&host_budget, k_uptime_get());
+    if (wait_ms) {
+        LOG_DBG("Host conn param update deferred %ums", wait_ms);
+        k_work_reschedule(&host_params_work, K_MSEC(wait_ms));
+        return;
+    }
 
-    if (info.role == BT_CONN_ROLE_CENTRAL && info.state == BT_CONN_STATE_CONNECTED) {
-        int err = bt_conn_le_subrate_request(conn, params);
-        if (err && err != -EALREADY) {
-            LOG_WRN("Failed to request subrate: %d", err);
+    LOG_INF("Host conn params: interval=%d-%d, latency=%d, timeout=%d",
+            params->interval_min, params->interval_max, params->latency, params->timeout);
+
+    host_params_applied = params;
+    bt_conn_foreach(BT_CONN_TYPE_LE, apply_conn_param_to_host, (void *)params);
+}
+
+static void host_params_set(const struct bt_le_conn_param *params, bool wake) {
+    host_params_target = params;
+    host_params_wake = wake;
+    k_work_reschedule(&host_params_work, K_NO_WAIT);
+}
+
+#endif /* HOST_PARAMS_TIERED */
+
+struct subrate_tier {
+    /* Shown in logs, shell argument and settings key */
+    const char *name;
+    const struct bt_conn_le_subrate_param *params;
+    /* Host connection parameters while the keyboard as a whole is in the
+     * tier, NULL for the defaults
+     */
+    const struct bt_le_conn_param *host;
+};
+
+#if TIERS_FROM_DT
+
+#define TIER_DT_SPAN(node)    (DT_PROP(node, subrate_max) * (DT_PROP(node, max_latency) + 1))
+#define TIER_DT_TIMEOUT(node) DT_PROP_OR(node, supervision_timeout, SUBRATE_TIMEOUT)
+
+#define TIER_DT_HOST(node, idx) DT_PROP_BY_IDX(node, host_conn_params, idx)
+#define TIER_DT_HOST_SPAN_MS(node)                                                                 \
+    ((TIER_DT_HOST(node, 1) * 125 / 100) * (TIER_DT_HOST(node, 2) + 1))
+
+/* Apple guidelines validation, as for the Kconfig dormant parameters */
+#define TIER_DT_HOST_DEFINE(node)                                                                  \
+    BUILD_ASSERT(DT_PROP_LEN(node, host_conn_params) == 4,                                         \
+                 DT_NODE_FULL_NAME(node) ": host-conn-params needs 4 cells");                      \
+    BUILD_ASSERT(TIER_DT_HOST(node, 0) >= 12,                                                      \
+                 DT_NODE_FULL_NAME(node) ": host interval min must be >= 15ms (12 units)");        \
+    BUILD_ASSERT(TIER_DT_HOST(node, 0) % 12 == 0,                                                  \
+                 DT_NODE_FULL_NAME(node) ": host interval min must be a multiple of 15ms");        \
+    BUILD_ASSERT(TIER_DT_HOST(node, 1) >= TIER_DT_HOST(node, 0),                                   \
+                 DT_NODE_FULL_NAME(node) ": host interval max must be >= interval min");           \
+    BUILD_ASSERT(TIER_DT_HOST(node, 1) == TIER_DT_HOST(node, 0) ||                                 \
+                     TIER_DT_HOST(node, 1) >= TIER_DT_HOST(node, 0) + 12,                          \
+                 DT_NODE_FULL_NAME(node) ": host interval max must equal min or be 15ms greater"); \
+    BUILD_ASSERT(TIER_DT_HOST(node, 2) <= 30,                                                      \
+                 DT_NODE_FULL_NAME(node) ": host latency must be <= 30");                          \
+    BUILD_ASSERT(TIER_DT_HOST_SPAN_MS(node) <= 6000,                                               \
+                 DT_NODE_FULL_NAME(node) ": host interval max * (latency + 1) must be <= 6s");     \
+    BUILD_ASSERT(TIER_DT_HOST(node, 3) * 10 > TIER_DT_HOST_SPAN_MS(node) * 3,                      \
+                 DT_NODE_FULL_NAME(node) ": host timeout must be > interval_max * (latency + 1) * 3"); \
+    static const struct bt_le_conn_param DT_CAT(tier_host_, node) = {                              \
+        .interval_min = TIER_DT_HOST(node, 0),                                                     \
+        .interval_max = TIER_DT_HOST(node, 1),                                                     \
+        .latency = TIER_DT_HOST(node, 2),                                                          \
+        .timeout = TIER_DT_HOST(node, 3),                                                          \
+    };
+
+/* Same rules as the Kconfig tiers, checked per devicetree node */
+#define TIER_DT_DEFINE(node)                                                                       \
+    BUILD_ASSERT(DT_PROP(node, subrate_max) >= DT_PROP(node, subrate_min),                         \
+                 DT_NODE_FULL_NAME(node) ": subrate-max must be >= subrate-min");                  \
+    BUILD_ASSERT(TIER_DT_SPAN(node) <= 500,                                                        \
+                 DT_NODE_FULL_NAME(node) ": subrate-max * (max-latency + 1) must be <= 500");      \
+    BUILD_ASSERT(DT_PROP(node, continuation_number) < DT_PROP(node, subrate_max),                  \
+                 DT_NODE_FULL_NAME(node) ": continuation-number must be < subrate-max");           \
+    BUILD_ASSERT(TIER_DT_TIMEOUT(node) * 2 > 3 * TIER_DT_SPAN(node),                               \
+                 DT_NODE_FULL_NAME(node) ": supervision timeout too low");                         \
+    static const struct bt_conn_le_subrate_param DT_CAT(tier_params_, node) = {                    \
+        .subrate_min = DT_PROP(node, subrate_min),                                                 \
+        .subrate_max = DT_PROP(node, subrate_max),                                                 \
+        .max_latency = DT_PROP(node, max_latency),                                                 \
+        .continuation_number = DT_PROP(node, continuation_number),                                 \
+        .supervision_timeout = TIER_DT_TIMEOUT(node),                                              \
+    };                                                                                             \
+    IF_ENABLED(DT_NODE_HAS_PROP(node, host_conn_params), (TIER_DT_HOST_DEFINE(node)))
+
+#define TIER_DT_ENTRY(node)                                                                        \
+    {                                                                                              \
+        .name = DT_NODE_FULL_NAME(node),                                                           \
+        .params = &DT_CAT(tier_params_, node),                                                     \
+        .host = COND_CODE_1(DT_NODE_HAS_PROP(node, host_conn_params),                              \
+                            (&DT_CAT(tier_host_, node)), (NULL)),                                  \
+    },
+
+#define TIER_DT_ENTRY_DELAY(node) DT_PROP(node, entry_delay_ms),
+
+DT_FOREACH_CHILD_STATUS_OKAY(TIERS_NODE, TIER_DT_DEFINE)
+
+static const struct subrate_tier tiers[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY(TIERS_NODE, TIER_DT_ENTRY)
+};
+
+static const uint32_t tier_entry_delay_ms[] = {
+    DT_FOREACH_CHILD_STATUS_OKAY(TIERS_NODE, TIER_DT_ENTRY_DELAY)
+};
+
+#else
+
+static const struct subrate_tier tiers[] = {
+    { .name = "active", .params = &active_params },
+    { .name = "idle", .params = &idle_params },
+    {
+        .name = "dormant",
+        .params = &dormant_params,
+#if IS_ENABLED(CONFIG_ZMK_BLE_HOST_CONN_PARAM_DORMANT)
+        .host = &host_dormant_params,
+#endif
+    },
+};
+
+/* Links leave ACTIVE on their own inactivity timeout */
+static const uint32_t tier_entry_delay_ms[] = { 0, LINK_IDLE_TIMEOUT_MS, SUBRATE_DORMANT_DELAY_MS };
+
+#endif /* TIERS_FROM_DT */
+
+#define TIER_COUNT ARRAY_SIZE(tiers)
+/* Entered on key presses */
+#define TIER_ACTIVE 0
+/* Where new links start and the keyboard goes when ZMK reports it idle */
+#define TIER_IDLE 1
+
+BUILD_ASSERT(ARRAY_SIZE(tiers) >= 2 && ARRAY_SIZE(tiers) <= 16,
+    "Subrating needs between 2 and 16 tiers");
+
+static const struct subrate_ladder link_ladder = {
+    .entry_delay_ms = tier_entry_delay_ms,
+    .count = TIER_COUNT,
+    .min_dwell_ms = MIN_DWELL_MS,
+};
+
+/* The keyboard as a whole enters TIER_IDLE when ZMK says so */
+static const struct subrate_ladder activity_ladder = {
+    .entry_delay_ms = tier_entry_delay_ms,
+    .count = TIER_COUNT,
+};
+
+/* Tier parameters, unless replaced at runtime with
+ * zmk_sdc_subrating_tier_set()
+ */
+static struct bt_conn_le_subrate_param tier_custom[TIER_COUNT];
+static bool tier_customized[TIER_COUNT];
+
+static const struct bt_conn_le_subrate_param *tier_base(uint8_t tier) {
+    return tier_customized[tier] ? &tier_custom[tier] : tiers[tier].params;
+}
+
+/* Activity of the keyboard as a whole; drives the host connection and
+ * pushes links that are still in a higher tier down to its tier.
+ */
+static struct subrate_ladder_pos activity = { .tier = TIER_IDLE };
+
+static void activity_step_handler(struct k_work *work);
+static K_WORK_DELAYABLE_DEFINE(activity_step_work, activity_step_handler);
+
+/*
+ * Split links, one per central-role connection. Each link walks the tier
+ * ladder on its own: it goes to the first tier on key presses from its
+ * peripheral and down one tier after each entry delay without them, so an
+ * unused half stays in deep subrating while the other one types.
+ *
+ * A link is stored at the ZMK split peripheral slot of its peripheral,
+ * which is what position events carry as their source. The slot is read
+ * from ZMK's settings; without CONFIG_SETTINGS links are left at the
+ * controller defaults.
+ */
+struct subrate_link {
+    struct bt_conn *conn;
+    struct subrate_ladder_pos pos;
+    uint32_t interval_us;
+    struct k_work_delayable idle_work;
+
+    /* A subrate request for the current tier is still to be sent */
+    bool request_pending;
+    /* A subrate procedure is running, waiting for subrate_changed */
+    bool request_in_flight;
+    struct subrate_budget budget;
+    struct k_work_delayable request_work;
+
+    uint32_t procedures;
+    uint32_t coalesced;
+    uint32_t deferred;
+
+    /* Last request sent and what the link actually runs with, with the
+     * tiers they were made for
+     */
+    struct bt_conn_le_subrate_param requested;
+    struct bt_conn_le_subrate_changed effective;
+    uint8_t requested_tier;
+    uint8_t effective_tier;
+    bool diverged;
+    bool unsupported;
+    /* Retries of the current tier's request, and how far it was relaxed
+     * after the peer rejected the parameters
+     */
+    uint8_t retries;
+    uint8_t relax;
+    struct k_work_delayable retry_work;
+
+    /* Arrival of the last key event from the peripheral */
+    int64_t last_data_ms;
+
+    /* Battery band of the peripheral, and the one the link runs with */
+    uint8_t peripheral_band;
+    uint8_t band;
+};
+
+static struct subrate_link links[CONFIG_BT_MAX_CONN];
+
+static struct subrate_link *link_for_conn(struct bt_conn *conn) {
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        if (links[i].conn == conn) {
+            return &links[i];
+        }
+    }
+
+    return NULL;
+}
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+
+/*
+ * Battery bands. Below a band's level, the tiers under the first one may
+ * use a larger subrate factor and the tiers under TIER_IDLE are entered
+ * sooner. A link runs in the lower band of the central and its
+ * peripheral; the keyboard as a whole in the band of the central.
+ */
+
+#define BATTERY_HYSTERESIS       5
+
+enum battery_band { BAND_NORMAL, BAND_LOW, BAND_CRITICAL, BAND_COUNT };
+
+struct battery_band_cfg {
+    const char *name;
+    /* Entered at or below this state of charge */
+    uint8_t level;
+    /* Scale of the subrate factor maximum and of the entry delays, in % */
+    uint16_t factor_pct;
+    uint16_t delay_pct;
+};
+
+static const struct battery_band_cfg bands[BAND_COUNT] = {
+    [BAND_NORMAL] = { .name = "normal", .level = 100, .factor_pct = 100, .delay_pct = 100 },
+    [BAND_LOW] = {
+        .name = "low",
+        .level = CONFIG_ZMK_BLE_SUBRATE_BATTERY_LOW_LEVEL,
+        .factor_pct = CONFIG_ZMK_BLE_SUBRATE_BATTERY_LOW_FACTOR,
+        .delay_pct = CONFIG_ZMK_BLE_SUBRATE_BATTERY_LOW_DELAY,
+    },
+    [BAND_CRITICAL] = {
+        .name = "critical",
+        .level = CONFIG_ZMK_BLE_SUBRATE_BATTERY_CRITICAL_LEVEL,
+        .factor_pct = CONFIG_ZMK_BLE_SUBRATE_BATTERY_CRITICAL_FACTOR,
+        .delay_pct = CONFIG_ZMK_BLE_SUBRATE_BATTERY_CRITICAL_DELAY,
+    },
+};
+
+BUILD_ASSERT(CONFIG_ZMK_BLE_SUBRATE_BATTERY_CRITICAL_LEVEL <
+             CONFIG_ZMK_BLE_SUBRATE_BATTERY_LOW_LEVEL,
+    "BATTERY_CRITICAL_LEVEL must be < BATTERY_LOW_LEVEL");
+
+static uint8_t central_band;
+
+/* Ladders with the entry delays of each band, filled in at init */
+static uint32_t band_entry_delay_ms[BAND_COUNT][TIER_COUNT];
+static struct subrate_ladder band_link_ladder[BAND_COUNT];
+static struct subrate_ladder band_activity_ladder[BAND_COUNT];
+
+static void battery_ladders_init(void) {
+    for (int band = 0; band < BAND_COUNT; band++) {
+        for (int i = 0; i < TIER_COUNT; i++) {
+            uint64_t delay_ms = tier_entry_delay_ms[i];
+
+            if (i > TIER_IDLE) {
+                delay_ms = delay_ms * bands[band].delay_pct / 100;
+            }
+            band_entry_delay_ms[band][i] = (uint32_t)delay_ms;
         }
+
+        band_link_ladder[band] = link_ladder;
+        band_link_ladder[band].entry_delay_ms = band_entry_delay_ms[band];
+        band_activity_ladder[band] = activity_ladder;
+        band_activity_ladder[band].entry_delay_ms = band_entry_delay_ms[band];
     }
 }
 
-static void set_tier(enum subrate_tier tier) {
-    if (tier == current_tier) {
+static const struct subrate_ladder *link_ladder_get(const struct subrate_link *link) {
+    return &band_link_ladder[link->band];
+}
+
+static const struct subrate_ladder *activity_ladder_get(void) {
+    return &band_activity_ladder[central_band];
+}
+
+/* Larger factor maximum, within the limits tier_params_validate() checks */
+static void battery_scale(struct bt_conn_le_subrate_param *params, uint8_t band) {
+    uint32_t lat_events = params->max_latency + 1;
+    uint32_t limit =
+        MIN(500 / lat_events, (params->supervision_timeout * 2 - 1) / (3 * lat_events));
+    uint32_t max = params->subrate_max * bands[band].factor_pct / 100;
+
+    params->subrate_max = MAX(MIN(max, limit), params->subrate_max);
+}
+
+#else
+
+static const struct subrate_ladder *link_ladder_get(const struct subrate_link *link) {
+    return &link_ladder;
+}
+
+static const struct subrate_ladder *activity_ladder_get(void) {
+    return &activity_ladder;
+}
+
+#endif /* CONFIG_ZMK_BLE_SUBRATE_BATTERY */
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_USB_POWER)
+/* Links are held in the first tier, unsubrated, while the central is on
+ * USB power
+ */
+static bool usb_powered;
+#else
+#define usb_powered false
+#endif
+
+/* Longest wait for subrate_changed before another request may be sent */
+#define REQUEST_IN_FLIGHT_TIMEOUT_MS 5000
+
+static const struct bt_conn_le_subrate_param *tier_params(uint8_t tier);
+
+#define RETRY_MAX                 CONFIG_ZMK_BLE_SUBRATE_RETRY_MAX
+#define RETRY_BASE_MS             1000
+#define RETRY_MAX_BACKOFF_MS      64000
+
+/* Tier parameters as they apply to the link */
+static void link_tier_params(struct subrate_link *link, uint8_t tier,
+                             struct bt_conn_le_subrate_param *params) {
+    *params = *tier_params(tier);
+
+    if (usb_powered && tier == TIER_ACTIVE) {
+        /* Every connection event, keeping the supervision timeout */
+        params->subrate_min = 1;
+        params->subrate_max = 1;
+        params->max_latency = 0;
+        params->continuation_number = 0;
         return;
     }
 
-    enum subrate_tier prev_tier = current_tier;
-    current_tier = tier;
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+    if (tier >= TIER_IDLE && link->band != BAND_NORMAL) {
+        battery_scale(params, link->band);
+    }
+#endif
+}
 
-    const struct bt_conn_le_subrate_param *params;
-    const char *tier_name;
+/* Tier parameters, relaxed towards a smaller factor for each rejection */
+static void link_request_params(struct subrate_link *link,
+                                struct bt_conn_le_subrate_param *params) {
+    link_tier_params(link, link->pos.tier, params);
 
-    switch (tier) {
-    case TIER_ACTIVE:
-        params = &active_params;
-        tier_name = "ACTIVE";
-        break;
-    case TIER_IDLE:
-        params = &idle_params;
-        tier_name = "IDLE";
-        break;
-    case TIER_DORMANT:
-        params = &dormant_params;
-        tier_name = "DORMANT";
-        break;
-    default:
+    if (link->relax == 0) {
         return;
     }
 
-    LOG_INF("Subrating tier: %s (factor=%d-%d, latency=%d, cn=%d)",
-            tier_name, params->subrate_min, params->subrate_max,
-            params->max_latency, params->continuation_number);
+    params->subrate_max = MAX(params->subrate_min, params->subrate_max >> link->relax);
+    params->continuation_number =
+        MIN(params->continuation_number, params->subrate_max - 1);
+}
 
-    bt_conn_le_subrate_set_defaults(params);
-    bt_conn_foreach(BT_CONN_TYPE_LE, apply_subrate_to_conn, (void *)params);
+static void link_retry(struct subrate_link *link) {
+    if (link->retries >= RETRY_MAX) {
+        LOG_WRN("Subrating [%d]: giving up after %d retries, effective factor=%d",
+                (int)ARRAY_INDEX(links, link), link->retries, link->effective.factor);
+        return;
+    }
 
-#if IS_ENABLED(CONFIG_ZMK_BLE_HOST_CONN_PARAM_DORMANT)
-    /* Update host connection parameters when entering/exiting dormant */
-    if (tier == TIER_DORMANT) {
-        LOG_INF("Host conn params: dormant (interval=%d-%d, latency=%d)",
-                HOST_DORMANT_INT_MIN, HOST_DORMANT_INT_MAX, HOST_DORMANT_LATENCY);
-        bt_conn_foreach(BT_CONN_TYPE_LE, apply_conn_param_to_host,
-                        (void *)&host_dormant_params);
-    } else if (prev_tier == TIER_DORMANT) {
-        LOG_INF("Host conn params: active (interval=%d-%d, latency=%d)",
-                CONFIG_BT_PERIPHERAL_PREF_MIN_INT, CONFIG_BT_PERIPHERAL_PREF_MAX_INT,
-                CONFIG_BT_PERIPHERAL_PREF_LATENCY);
-        bt_conn_foreach(BT_CONN_TYPE_LE, apply_conn_param_to_host,
-                        (void *)&host_active_params);
+    uint32_t backoff_ms = MIN(RETRY_BASE_MS << link->retries, RETRY_MAX_BACKOFF_MS);
+
+    link->retries++;
+    k_work_reschedule(&link->retry_work, K_MSEC(backoff_ms));
+}
+
+static void link_request_send(struct subrate_link *link) {
+    if (!link->request_pending || link->conn == NULL || link->unsupported) {
+        return;
     }
-#endif
+
+    /* subrate_changed sends what has piled up in the meantime */
+    if (link->request_in_flight) {
+        return;
+    }
+
+    /* Only step-downs are charged; a key press never waits for the budget */
+    uint32_t wait_ms = link->pos.tier == TIER_ACTIVE
+                           ? 0
+                           : subrate_budget_take(&link->budget, k_uptime_get());
+    if (wait_ms) {
+        link->deferred++;
+        k_work_reschedule(&link->request_work, K_MSEC(wait_ms));
+        return;
+    }
+
+    struct bt_conn_le_subrate_param params;
+
+    link_request_params(link, &params);
+
+    /* Blocks on the HCI command; the disconnect cleanup runs on this queue
+     * too, the reference keeps the connection valid until then.
+     */
+    struct bt_conn *conn = bt_conn_ref(link->conn);
+    int err = bt_conn_le_subrate_request(conn, &params);
+
+    bt_conn_unref(conn);
+    if (err && err != -EALREADY) {
+        /* Never reached the peer: keep the request and the token for the retry */
+        LOG_WRN("Failed to request subrate [%d]: %d", (int)ARRAY_INDEX(links, link), err);
+        subrate_budget_refund(&link->budget);
+        link_retry(link);
+        return;
+    }
+
+    link->request_pending = false;
+    link->requested_tier = link->pos.tier;
+    link->requested = params;
+
+    link->procedures++;
+    link->request_in_flight = true;
+    k_work_reschedule(&link->request_work, K_MSEC(REQUEST_IN_FLIGHT_TIMEOUT_MS));
 }
 
-static void dormant_timer_handler(struct k_work *work) {
-    set_tier(TIER_DORMANT);
+/* Ask for the parameters of the link's current tier */
+static void link_request(struct subrate_link *link) {
+    if (link->request_pending) {
+        link->coalesced++;
+    }
+
+    link->request_pending = true;
+    link_request_send(link);
 }
 
-static void subrate_active(void) {
-    k_work_cancel_delayable(&dormant_work);
-    set_tier(TIER_ACTIVE);
+static void link_retry_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct subrate_link *link = CONTAINER_OF(dwork, struct subrate_link, retry_work);
+
+    link_request(link);
 }
 
-static void subrate_idle(void) {
-    k_work_cancel_delayable(&dormant_work);
-    set_tier(TIER_IDLE);
-    k_work_schedule(&dormant_work, K_MSEC(SUBRATE_DORMANT_DELAY_MS));
+static void link_request_work_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct subrate_link *link = CONTAINER_OF(dwork, struct subrate_link, request_work);
+
+    /* Budget wait over, or subrate_changed never came */
+    link->request_in_flight = false;
+    link_request_send(link);
 }
 
-static int subrating_activity_listener(const zmk_event_t *eh) {
-    struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
-    if (ev == NULL) {
-        return -ENOTSUP;
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_CN_TUNE)
+
+/*
+ * Continuation number tuning. A key event from a peripheral that arrives
+ * within the continuation window after the previous one goes out on the
+ * next connection event; one that arrives after the window closed waits
+ * for the next subrated event. Events in the subrated period right after
+ * the window would have been on time with a larger continuation number;
+ * these are the late ones. Each tier's continuation number follows the
+ * share of late events, measured with the parameters the link actually
+ * runs with, towards CN_TUNE_TARGET.
+ *
+ * Arrival times at the central stand in for connection event counters;
+ * they are off by at most one subrated period, the same for every event.
+ */
+
+#define CN_TUNE_TARGET           CONFIG_ZMK_BLE_SUBRATE_CN_TUNE_LATE_TARGET
+#define CN_TUNE_WINDOW           CONFIG_ZMK_BLE_SUBRATE_CN_TUNE_WINDOW
+#define CN_TUNE_MAX              CONFIG_ZMK_BLE_SUBRATE_CN_TUNE_MAX
+
+struct cn_tune {
+    uint16_t events;
+    uint16_t late;
+    bool tuned;
+    /* Base parameters with the tuned continuation number */
+    struct bt_conn_le_subrate_param params;
+};
+
+static struct cn_tune cn_tune[TIER_COUNT];
+
+static const struct bt_conn_le_subrate_param *cn_tune_params(uint8_t tier) {
+    return cn_tune[tier].tuned ? &cn_tune[tier].params : tier_base(tier);
+}
+
+static void cn_tune_reset(uint8_t tier) {
+    cn_tune[tier] = (struct cn_tune){0};
+}
+
+static void cn_tune_step(uint8_t tier) {
+    struct cn_tune *tune = &cn_tune[tier];
+    const struct bt_conn_le_subrate_param *base = tier_base(tier);
+    uint32_t late_pm = tune->late * 1000 / tune->events;
+    int cn = cn_tune_params(tier)->continuation_number;
+    int next = cn;
+
+    tune->events = 0;
+    tune->late = 0;
+
+    if (late_pm > CN_TUNE_TARGET) {
+        next = cn + MAX(cn / 4, 1);
+    } else if (late_pm < CN_TUNE_TARGET / 2 && cn > 0) {
+        next = cn - 1;
     }
 
-    switch (ev->state) {
-    case ZMK_ACTIVITY_ACTIVE:
-        subrate_active();
-        break;
-    case ZMK_ACTIVITY_IDLE:
-    case ZMK_ACTIVITY_SLEEP:
-        subrate_idle();
-        break;
-    default:
-        LOG_WRN("Unhandled activity state: %d", ev->state);
-        return -EINVAL;
+    next = MIN(next, MIN(CN_TUNE_MAX, base->subrate_max - 1));
+
+    LOG_DBG("Subrating tier %s: %u.%u%% late, cn=%d", tiers[tier].name, late_pm / 10,
+            late_pm % 10, cn);
+
+    if (next == cn) {
+        return;
+    }
+
+    tune->params = *base;
+    tune->params.continuation_number = next;
+    tune->tuned = true;
+
+    LOG_INF("Subrating tier %s: continuation number %d -> %d (%u.%u%% late)",
+            tiers[tier].name, cn, next, late_pm / 10, late_pm % 10);
+
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        if (links[i].conn && links[i].pos.tier == tier) {
+            link_request(&links[i]);
+        }
     }
-    return 0;
 }
 
-ZMK_LISTENER(sdc_subrating, subrating_activity_listener);
-ZMK_SUBSCRIPTION(sdc_subrating, zmk_activity_state_changed);
+static void cn_tune_data(struct subrate_link *link, int64_t timestamp) {
+    int64_t gap_ms = timestamp - link->last_data_ms;
+    bool first = link->last_data_ms == 0;
 
-static int zmk_sdc_subrating_init(void) {
-    int err = bt_conn_le_subrate_set_defaults(&idle_params);
-    if (err) {
-        LOG_ERR("Failed to set subrating defaults: %d", err);
-        return err;
+    link->last_data_ms = timestamp;
+
+    /* Still on the requested parameters until subrate_changed came */
+    uint8_t tier = link->effective.factor ? link->effective_tier : link->requested_tier;
+    uint32_t factor = link->effective.factor ? link->effective.factor
+                                             : link->requested.subrate_max;
+    uint32_t cn = link->effective.factor ? link->effective.continuation_number
+                                         : link->requested.continuation_number;
+
+    if (first || factor <= 1 ||
+        (tier == TIER_ACTIVE && IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE))) {
+        return;
     }
 
-    LOG_INF("Subrating: active=%d-%d/%d, idle=%d-%d/%d, dormant=%d-%d/%d (delay=%ds)",
-            SUBRATE_ACTIVE_MIN, SUBRATE_ACTIVE_MAX, SUBRATE_ACTIVE_MAX_LATENCY,
-            SUBRATE_IDLE_MIN, SUBRATE_IDLE_MAX, SUBRATE_IDLE_MAX_LATENCY,
-            SUBRATE_DORMANT_MIN, SUBRATE_DORMANT_MAX, SUBRATE_DORMANT_MAX_LATENCY,
-            SUBRATE_DORMANT_DELAY_MS / 1000);
+    struct cn_tune *tune = &cn_tune[tier];
+    int64_t window_ms = (int64_t)(cn + 1) * link->interval_us / 1000;
+    int64_t period_ms = (int64_t)factor * link->interval_us / 1000;
 
-    return 0;
+    tune->events++;
+    if (gap_ms > window_ms && gap_ms <= window_ms + period_ms) {
+        tune->late++;
+    }
+
+    if (tune->events >= CN_TUNE_WINDOW) {
+        cn_tune_step(tier);
+    }
 }
 
-SYS_INIT(zmk_sdc_subrating_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+#else
 
-#endif /* CONFIG_ZMK_SPLIT_ROLE_CENTRAL */
+static const struct bt_conn_le_subrate_param *cn_tune_params(uint8_t tier) {
+    return tier_base(tier);
+}
 
-#if IS_ENABLED(CONFIG_ZMK_SPLIT) && !IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+static void cn_tune_reset(uint8_t tier) {}
+
+static void cn_tune_data(struct subrate_link *link, int64_t timestamp) {}
+
+#endif /* CONFIG_ZMK_BLE_SUBRATE_CN_TUNE */
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE)
 
 /*
- * Peripheral half: request ACTIVE subrate when local activity is detected.
- * This ensures the peripheral can send keystrokes quickly without waiting
- * for the central to initiate a tier change.
+ * Adaptive ACTIVE tier: the subrate factor and continuation number follow
+ * the measured typing cadence.
+ *
+ * A key pressed within the continuation window of the previous one goes
+ * out on the next connection event; any other key waits for up to one
+ * subrated event. Two candidates meet the p99 latency target:
+ *  - a factor small enough that subrated events alone meet the target, or
+ *  - the largest allowed factor with a continuation window covering 99%
+ *    of inter-key intervals.
+ * The one with fewer connection events per second is used.
  */
 
-static const struct bt_conn_le_subrate_param peripheral_active_params = {
-    .subrate_min = 1,
-    .subrate_max = 2,
-    .max_latency = 0,
-    .continuation_number = 1,
-    .supervision_timeout = 400, /* 4 seconds */
-};
+#define ADAPTIVE_TARGET_US       (CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE_P99_TARGET * 1000)
+#define ADAPTIVE_MAX_FACTOR      CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE_MAX_FACTOR
+#define ADAPTIVE_MAX_CN          CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE_MAX_CN
+#define ADAPTIVE_MIN_SAMPLES     CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE_MIN_SAMPLES
+#define ADAPTIVE_UPDATE_KEYS     CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE_UPDATE_KEYS
+
+/* Inter-key interval histogram; intervals past the last bucket are pauses */
+#define CADENCE_BUCKET_MS        10
+#define CADENCE_BUCKETS          150
+/* Halve the histogram past this many samples so it follows the typist */
+#define CADENCE_DECAY_TOTAL      2048
+/* Intervals are capped here for the keystroke rate EWMA */
+#define CADENCE_RATE_CAP_MS      10000
+#define CADENCE_EWMA_WEIGHT      16
+
+/* Connection interval when no split link is up (7.5 ms) */
+#define DEFAULT_CONN_INTERVAL_US 7500
+
+#if !TIERS_FROM_DT
+/* Devicetree tiers have their own timeouts; the factor is clamped to them at runtime */
+BUILD_ASSERT(SUBRATE_TIMEOUT * 2 > 3 * ADAPTIVE_MAX_FACTOR * (SUBRATE_ACTIVE_MAX_LATENCY + 1),
+    "TIMEOUT too low for adaptive factor maximum");
+#endif
 
-static bool peripheral_is_active = false;
+static uint16_t cadence_hist[CADENCE_BUCKETS + 1];
+static uint32_t cadence_total;
+static uint32_t cadence_ewma_ms = CADENCE_RATE_CAP_MS;
+static int64_t last_press_ms;
+static uint32_t keys_since_update;
 
-static void apply_subrate_to_peripheral_conn(struct bt_conn *conn, void *data) {
-    const struct bt_conn_le_subrate_param *params = data;
-    struct bt_conn_info info;
+static struct bt_conn_le_subrate_param adaptive_params;
+static bool adaptive_ready;
 
-    bt_conn_get_info(conn, &info);
+static void cadence_record(uint32_t interval_ms) {
+    uint32_t bucket = MIN(interval_ms / CADENCE_BUCKET_MS, CADENCE_BUCKETS);
 
-    if (info.role == BT_CONN_ROLE_PERIPHERAL && info.state == BT_CONN_STATE_CONNECTED) {
-        int err = bt_conn_le_subrate_request(conn, params);
-        if (err && err != -EALREADY) {
-            LOG_WRN("Peripheral failed to request subrate: %d", err);
+    if (cadence_total >= CADENCE_DECAY_TOTAL) {
+        cadence_total = 0;
+        for (int i = 0; i <= CADENCE_BUCKETS; i++) {
+            cadence_hist[i] /= 2;
+            cadence_total += cadence_hist[i];
         }
     }
+
+    cadence_hist[bucket]++;
+    cadence_total++;
+
+    /* EWMA of the interval for the key press rate */
+    int32_t sample = MIN(interval_ms, CADENCE_RATE_CAP_MS);
+
+    cadence_ewma_ms += (sample - (int32_t)cadence_ewma_ms) / CADENCE_EWMA_WEIGHT;
 }
 
-static int peripheral_subrating_activity_listener(const zmk_event_t *eh) {
-    struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
-    if (ev == NULL) {
-        return -ENOTSUP;
-    }
+/* Interval in ms covering 99% of samples, 0 if pauses exceed 1% */
+static uint32_t cadence_p99_ms(void) {
+    uint32_t needed = cadence_total - cadence_total / 100;
+    uint32_t sum = 0;
 
-    if (ev->state == ZMK_ACTIVITY_ACTIVE) {
-        if (!peripheral_is_active) {
-            LOG_INF("Peripheral requesting ACTIVE subrate");
-            bt_conn_foreach(BT_CONN_TYPE_LE, apply_subrate_to_peripheral_conn,
-                            (void *)&peripheral_active_params);
-            peripheral_is_active = true;
+    for (int i = 0; i < CADENCE_BUCKETS; i++) {
+        sum += cadence_hist[i];
+        if (sum >= needed) {
+            return (i + 1) * CADENCE_BUCKET_MS;
         }
-    } else {
-        peripheral_is_active = false;
+    }
+
+    return 0;
+}
+
+/* Connection events per 1000 s with the given parameters */
+static uint64_t adaptive_cost(uint32_t interval_us, uint32_t factor, uint32_t cn) {
+    uint64_t subrated = 1000000000ULL / ((uint64_t)factor * interval_us);
+    uint32_t window_ms = cn * interval_us / 1000;
+    uint64_t continuation_ms = 0;
+
+    if (cn == 0 || cadence_total == 0) {
+        return subrated;
+    }
+
+    /* Mean continuation time spent per key press */
+    for (int i = 0; i <= CADENCE_BUCKETS; i++) {
+        uint32_t mid_ms = i * CADENCE_BUCKET_MS + CADENCE_BUCKET_MS / 2;
+
+        continuation_ms += (uint64_t)cadence_hist[i] * MIN(mid_ms, window_ms);
+    }
+    continuation_ms /= cadence_total;
+
+    /* key presses per 1000 s * continuation events per key press */
+    uint64_t presses = 1000000ULL / MAX(cadence_ewma_ms, 1);
+
+    return subrated + presses * continuation_ms * 1000 / interval_us;
+}
+
+static void adaptive_compute(uint32_t interval_us, struct bt_conn_le_subrate_param *out) {
+    const struct bt_conn_le_subrate_param *base = tier_base(TIER_ACTIVE);
+    uint32_t lat_events = base->max_latency + 1;
+    /* Same bounds as zmk_sdc_subrating_tier_set() checks */
+    uint32_t timeout_max = (base->supervision_timeout * 2 - 1) / (3 * lat_events);
+    uint32_t factor_max = MAX(MIN(MIN(ADAPTIVE_MAX_FACTOR, 500 / lat_events), timeout_max), 1);
+    uint32_t factor = CLAMP(ADAPTIVE_TARGET_US / interval_us, 1, factor_max);
+    uint32_t cn = 0;
+    uint64_t cost = adaptive_cost(interval_us, factor, 0);
+    uint32_t p99_ms = cadence_p99_ms();
+
+    if (p99_ms > 0 && factor_max > factor) {
+        uint32_t cn_p99 = DIV_ROUND_UP(p99_ms * 1000, interval_us);
+
+        if (cn_p99 <= ADAPTIVE_MAX_CN && cn_p99 < factor_max) {
+            uint64_t cost_p99 = adaptive_cost(interval_us, factor_max, cn_p99);
+
+            if (cost_p99 < cost) {
+                factor = factor_max;
+                cn = cn_p99;
+                cost = cost_p99;
+            }
+        }
+    }
+
+    *out = (struct bt_conn_le_subrate_param){
+        .subrate_min = MIN(base->subrate_min, factor),
+        .subrate_max = factor,
+        .max_latency = base->max_latency,
+        .continuation_number = cn,
+        .supervision_timeout = base->supervision_timeout,
+    };
+
+    LOG_DBG("Cadence: %u samples, p99=%ums, mean=%ums -> factor=%u, cn=%u (%llu events/ks)",
+            cadence_total, p99_ms, cadence_ewma_ms, factor, cn, cost);
+}
+
+static void adaptive_update(void) {
+    uint32_t interval_us = UINT32_MAX;
+    struct bt_conn_le_subrate_param params;
+
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        if (links[i].conn) {
+            interval_us = MIN(interval_us, links[i].interval_us);
+        }
+    }
+    if (interval_us == UINT32_MAX) {
+        interval_us = DEFAULT_CONN_INTERVAL_US;
+    }
+
+    adaptive_compute(interval_us, &params);
+
+    if (adaptive_ready && memcmp(&params, &adaptive_params, sizeof(params)) == 0) {
+        return;
+    }
+
+    adaptive_params = params;
+    adaptive_ready = true;
+
+    LOG_INF("Subrating adaptive: factor=%d-%d, latency=%d, cn=%d",
+            params.subrate_min, params.subrate_max, params.max_latency,
+            params.continuation_number);
+
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        if (links[i].conn && links[i].pos.tier == TIER_ACTIVE) {
+            link_request(&links[i]);
+        }
+    }
+}
+
+static void cadence_press(int64_t timestamp) {
+    if (last_press_ms > 0 && activity.tier == TIER_ACTIVE) {
+        cadence_record((uint32_t)MIN(timestamp - last_press_ms, UINT32_MAX));
+
+        if (cadence_total >= ADAPTIVE_MIN_SAMPLES &&
+            (!adaptive_ready || ++keys_since_update >= ADAPTIVE_UPDATE_KEYS)) {
+            keys_since_update = 0;
+            adaptive_update();
+        }
+    }
+    last_press_ms = timestamp;
+}
+
+static const struct bt_conn_le_subrate_param *active_tier_params(void) {
+    return adaptive_ready ? &adaptive_params : tier_base(TIER_ACTIVE);
+}
+
+static void adaptive_reset(void) {
+    adaptive_ready = false;
+}
+
+#else
+
+static const struct bt_conn_le_subrate_param *active_tier_params(void) {
+    return cn_tune_params(TIER_ACTIVE);
+}
+
+static void adaptive_reset(void) {}
+
+static void cadence_press(int64_t timestamp) {}
+
+#endif /* CONFIG_ZMK_BLE_SUBRATE_ADAPTIVE */
+
+static const struct bt_conn_le_subrate_param *tier_params(uint8_t tier) {
+    if (tier == TIER_ACTIVE) {
+        return active_tier_params();
+    }
+
+    return cn_tune_params(tier);
+}
+
+static void link_tier_changed(struct subrate_link *link) {
+    link->retries = 0;
+    link->relax = 0;
+    k_work_cancel_delayable(&link->retry_work);
+
+    struct bt_conn_le_subrate_param params;
+
+    link_tier_params(link, link->pos.tier, &params);
+
+    LOG_INF("Subrating tier [%d]: %s (factor=%d-%d, latency=%d, cn=%d)",
+            (int)ARRAY_INDEX(links, link), tiers[link->pos.tier].name, params.subrate_min,
+            params.subrate_max, params.max_latency, params.continuation_number);
+
+    link_request(link);
+}
+
+/* Time the link's next step down, never below the keyboard's tier */
+static void link_schedule(struct subrate_link *link) {
+    if (usb_powered) {
+        k_work_cancel_delayable(&link->idle_work);
+        return;
+    }
+
+    int64_t next_ms = subrate_ladder_next_ms(link_ladder_get(link), &link->pos, activity.tier);
+
+    if (next_ms == SUBRATE_LADDER_NEVER) {
+        k_work_cancel_delayable(&link->idle_work);
+    } else {
+        k_work_reschedule(&link->idle_work, K_MSEC(MAX(next_ms - k_uptime_get(), 0)));
+    }
+}
+
+static void link_step(struct subrate_link *link) {
+    if (!usb_powered && subrate_ladder_advance(link_ladder_get(link), &link->pos, activity.tier, k_uptime_get())) {
+        link_tier_changed(link);
+    }
+
+    link_schedule(link);
+}
+
+static void link_idle_handler(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct subrate_link *link = CONTAINER_OF(dwork, struct subrate_link, idle_work);
+
+    if (link->conn) {
+        link_step(link);
+    }
+}
+
+static void link_activity(struct subrate_link *link) {
+    bool changed = link->pos.tier != TIER_ACTIVE;
+
+    /* Each key press restarts the time before the next step down */
+    subrate_ladder_enter(&link->pos, TIER_ACTIVE, k_uptime_get());
+    if (changed) {
+        link_tier_changed(link);
+    }
+
+    link_schedule(link);
+}
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_USB_POWER_HOST)
+#define usb_host_pinned() usb_powered
+#else
+#define usb_host_pinned() false
+#endif
+
+static void set_tier(uint8_t tier) {
+    if (tier == activity.tier) {
+        return;
+    }
+
+    uint8_t prev_tier = activity.tier;
+    subrate_ladder_enter(&activity, tier, k_uptime_get());
+
+    LOG_INF("Subrating activity: %s", tiers[tier].name);
+#if IS_ENABLED(CONFIG_MPSL_PM_STATS)
+    mpsl_pm_stats_tag_set(tier, tiers[tier].name);
+#endif
+
+    /* Links only go up on their own key presses; link_step() takes them
+     * down to the keyboard's tier once they have dwelt.
+     */
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        if (links[i].conn) {
+            link_step(&links[i]);
+        }
+    }
+
+#if HOST_PARAMS_TIERED
+    if (tiers[tier].host != tiers[prev_tier].host && !usb_host_pinned()) {
+        host_params_set(tiers[tier].host ? tiers[tier].host : &host_active_params,
+                        tier == TIER_ACTIVE);
+    }
+#else
+    ARG_UNUSED(prev_tier);
+#endif
+}
+
+static void activity_schedule(void) {
+    /* Only ZMK's idle state takes the keyboard out of the first tier */
+    if (activity.tier == TIER_ACTIVE) {
+        return;
+    }
+
+    int64_t next_ms = subrate_ladder_next_ms(activity_ladder_get(), &activity, 0);
+
+    if (next_ms != SUBRATE_LADDER_NEVER) {
+        k_work_reschedule(&activity_step_work, K_MSEC(MAX(next_ms - k_uptime_get(), 0)));
+    }
+}
+
+static void activity_step_handler(struct k_work *work) {
+    struct subrate_ladder_pos next = activity;
+
+    if (subrate_ladder_advance(activity_ladder_get(), &next, 0, k_uptime_get())) {
+        set_tier(next.tier);
+    }
+
+    activity_schedule();
+}
+
+static void subrate_active(void) {
+    k_work_cancel_delayable(&activity_step_work);
+    set_tier(TIER_ACTIVE);
+}
+
+static void subrate_idle(void) {
+    /* Already on the way down */
+    if (activity.tier >= TIER_IDLE) {
+        return;
+    }
+
+    set_tier(TIER_IDLE);
+    activity_schedule();
+}
+
+static int subrating_activity_listener(const zmk_event_t *eh) {
+    struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev == NULL) {
+        return -ENOTSUP;
+    }
+
+    switch (ev->state) {
+    case ZMK_ACTIVITY_ACTIVE:
+        subrate_active();
+        break;
+    case ZMK_ACTIVITY_IDLE:
+    case ZMK_ACTIVITY_SLEEP:
+        subrate_idle();
+        break;
+    default:
+        LOG_WRN("Unhandled activity state: %d", ev->state);
+        return -EINVAL;
+    }
+    return 0;
+}
+
+ZMK_LISTENER(sdc_subrating, subrating_activity_listener);
+ZMK_SUBSCRIPTION(sdc_subrating, zmk_activity_state_changed);
+
+static int subrating_position_listener(const zmk_event_t *eh) {
+    struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
+    if (ev == NULL) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    /* Local key events do not travel over a split link */
+    struct subrate_link *link =
+        ev->source < ARRAY_SIZE(links) && links[ev->source].conn ? &links[ev->source] : NULL;
+
+    /* Releases are data on the link as well */
+    if (link) {
+        cn_tune_data(link, ev->timestamp);
+    }
+
+    if (!ev->state) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    cadence_press(ev->timestamp);
+
+    if (link) {
+        link_activity(link);
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(sdc_subrating_position, subrating_position_listener);
+ZMK_SUBSCRIPTION(sdc_subrating_position, zmk_position_state_changed);
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+
+static uint8_t battery_band_for(uint8_t level, uint8_t current) {
+    uint8_t band = BAND_NORMAL;
+
+    while (band + 1 < BAND_COUNT && level <= bands[band + 1].level) {
+        band++;
+    }
+
+    /* Leave a band only once clearly above its level */
+    while (band < current && level <= bands[band + 1].level + BATTERY_HYSTERESIS) {
+        band++;
+    }
+
+    return band;
+}
+
+static void link_band_update(struct subrate_link *link) {
+    uint8_t band = MAX(central_band, link->peripheral_band);
+
+    if (band == link->band) {
+        return;
+    }
+
+    link->band = band;
+
+    /* The first tier is not scaled */
+    if (link->pos.tier >= TIER_IDLE) {
+        link_request(link);
+    }
+
+    link_schedule(link);
+}
+
+static int subrating_battery_listener(const zmk_event_t *eh) {
+    const struct zmk_battery_state_changed *ev = as_zmk_battery_state_changed(eh);
+    if (ev != NULL) {
+        uint8_t band = battery_band_for(ev->state_of_charge, central_band);
+
+        if (band != central_band) {
+            LOG_INF("Subrating battery: central at %d%%, band %s -> %s", ev->state_of_charge,
+                    bands[central_band].name, bands[band].name);
+
+            central_band = band;
+
+            for (int i = 0; i < ARRAY_SIZE(links); i++) {
+                if (links[i].conn) {
+                    link_band_update(&links[i]);
+                }
+            }
+
+            activity_schedule();
+        }
+
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+    const struct zmk_peripheral_battery_state_changed *pev =
+        as_zmk_peripheral_battery_state_changed(eh);
+    if (pev != NULL && pev->source < ARRAY_SIZE(links) && links[pev->source].conn) {
+        struct subrate_link *link = &links[pev->source];
+        uint8_t band = battery_band_for(pev->state_of_charge, link->peripheral_band);
+
+        if (band != link->peripheral_band) {
+            LOG_INF("Subrating battery: peripheral [%d] at %d%%, band %s -> %s", pev->source,
+                    pev->state_of_charge, bands[link->peripheral_band].name, bands[band].name);
+
+            link->peripheral_band = band;
+            link_band_update(link);
+        }
+    }
+#endif
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(sdc_subrating_battery, subrating_battery_listener);
+ZMK_SUBSCRIPTION(sdc_subrating_battery, zmk_battery_state_changed);
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE_CENTRAL_BATTERY_LEVEL_FETCHING)
+ZMK_SUBSCRIPTION(sdc_subrating_battery, zmk_peripheral_battery_state_changed);
+#endif
+
+#endif /* CONFIG_ZMK_BLE_SUBRATE_BATTERY */
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_USB_POWER)
+
+static void usb_power_changed(bool powered) {
+    if (powered == usb_powered) {
+        return;
+    }
+
+    usb_powered = powered;
+
+    LOG_INF("Subrating: USB power %s", powered ? "on" : "off");
+
+    /* Links restart from the first tier either way: pinned there while
+     * powered, walking down from it right away once unplugged.
+     */
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        struct subrate_link *link = &links[i];
+
+        if (!link->conn) {
+            continue;
+        }
+
+        subrate_ladder_enter(&link->pos, TIER_ACTIVE, k_uptime_get());
+        link_tier_changed(link);
+        link_schedule(link);
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_USB_POWER_HOST)
+    if (powered) {
+        host_params_set(&host_usb_params, true);
+    } else {
+        host_params_set(tiers[activity.tier].host ? tiers[activity.tier].host
+                                                  : &host_active_params,
+                        false);
+    }
+#endif
+}
+
+static int subrating_usb_listener(const zmk_event_t *eh) {
+    if (as_zmk_usb_conn_state_changed(eh) != NULL) {
+        usb_power_changed(zmk_usb_is_powered());
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(sdc_subrating_usb, subrating_usb_listener);
+ZMK_SUBSCRIPTION(sdc_subrating_usb, zmk_usb_conn_state_changed);
+
+#endif /* CONFIG_ZMK_BLE_SUBRATE_USB_POWER */
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE) && IS_ENABLED(CONFIG_SETTINGS)
+struct peripheral_slot_lookup {
+    const bt_addr_le_t *addr;
+    int slot;
+};
+
+static int peripheral_slot_load(const char *key, size_t len, settings_read_cb read_cb,
+                                void *cb_arg, void *param) {
+    struct peripheral_slot_lookup *lookup = param;
+    bt_addr_le_t addr;
+    char *end;
+    long slot = strtol(key, &end, 10);
+
+    if (end == key || *end != '\0' || len != sizeof(addr) ||
+        read_cb(cb_arg, &addr, sizeof(addr)) != sizeof(addr)) {
+        return 0;
+    }
+
+    if (bt_addr_le_eq(&addr, lookup->addr)) {
+        lookup->slot = (int)slot;
+    }
+
+    return 0;
+}
+#endif
+
+static int link_slot_for_conn(struct bt_conn *conn) {
+#if IS_ENABLED(CONFIG_ZMK_SPLIT_BLE) && IS_ENABLED(CONFIG_SETTINGS)
+    /* The split central stored the address at the peripheral's slot before
+     * connecting. Read it back rather than going through
+     * zmk_ble_put_peripheral_addr(), which would claim a free slot for an
+     * address it does not know.
+     */
+    struct peripheral_slot_lookup lookup = {
+        .addr = bt_conn_get_dst(conn),
+        .slot = -ENOENT,
+    };
+    int err = settings_load_subtree_direct("ble/peripheral_addresses", peripheral_slot_load,
+                                           &lookup);
+
+    return err ? err : lookup.slot;
+#else
+    /* Without settings ZMK's slots can not be read back, and a guessed one
+     * would credit key presses to the wrong link
+     */
+    return -ENOTSUP;
+#endif
+}
+
+/*
+ * Connection callbacks run on the BT RX thread. They only queue the event
+ * with a reference on the connection; links are set up and torn down on
+ * the system work queue, where all other link work runs, so no handler
+ * sees its link change under it.
+ */
+struct link_event {
+    struct bt_conn *conn;
+    bool connected;
+};
+
+K_MSGQ_DEFINE(link_events, sizeof(struct link_event), 2 * CONFIG_BT_MAX_CONN, 4);
+
+static void link_events_work_handler(struct k_work *work);
+static K_WORK_DEFINE(link_events_work, link_events_work_handler);
+
+static void link_event_queue(struct bt_conn *conn, bool connected) {
+    struct link_event event = {
+        .conn = bt_conn_ref(conn),
+        .connected = connected,
+    };
+
+    if (k_msgq_put(&link_events, &event, K_NO_WAIT)) {
+        LOG_WRN("Subrating link event dropped");
+        bt_conn_unref(event.conn);
+        return;
+    }
+
+    k_work_submit(&link_events_work);
+}
+
+/* Takes over the event's reference */
+static void link_setup(struct bt_conn *conn) {
+    struct bt_conn_info info;
+
+    if (bt_conn_get_info(conn, &info) || info.state != BT_CONN_STATE_CONNECTED) {
+        bt_conn_unref(conn);
+        return;
+    }
+
+    /* Reads the slot from settings, which is why this is not done in the
+     * connected callback
+     */
+    int slot = link_slot_for_conn(conn);
+    if (slot < 0 || slot >= ARRAY_SIZE(links) || links[slot].conn) {
+        LOG_WRN("No subrating slot for link: %d", slot);
+        bt_conn_unref(conn);
+        return;
+    }
+
+    struct subrate_link *link = &links[slot];
+
+    link->conn = conn;
+    /* New links start from the default parameters set at init */
+    subrate_ladder_enter(&link->pos, TIER_IDLE, k_uptime_get());
+    link->interval_us = info.le.interval * 1250;
+    link->request_pending = false;
+    link->request_in_flight = false;
+    link->budget = (struct subrate_budget)PROCEDURE_BUDGET_INIT;
+    link->procedures = 0;
+    link->coalesced = 0;
+    link->deferred = 0;
+    link->requested = *tier_params(TIER_IDLE);
+    link->effective = (struct bt_conn_le_subrate_changed){0};
+    link->requested_tier = TIER_IDLE;
+    link->effective_tier = TIER_IDLE;
+    link->last_data_ms = 0;
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+    /* Peripheral levels come in some time after connecting */
+    link->peripheral_band = BAND_NORMAL;
+    link->band = central_band;
+#endif
+    link->diverged = false;
+    link->unsupported = false;
+    link->retries = 0;
+    link->relax = 0;
+
+    if (usb_powered) {
+        subrate_ladder_enter(&link->pos, TIER_ACTIVE, k_uptime_get());
+        link_tier_changed(link);
+    } else if (activity.tier > TIER_IDLE) {
+        /* Nothing to dwell on while the keyboard is already further down */
+        subrate_ladder_enter(&link->pos, activity.tier, k_uptime_get());
+        link_tier_changed(link);
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+    /* The defaults are the unscaled IDLE parameters */
+    if (link->band != BAND_NORMAL && link->pos.tier == TIER_IDLE) {
+        link_request(link);
+    }
+#endif
+
+    link_schedule(link);
+}
+
+static void link_teardown(struct bt_conn *conn) {
+    struct subrate_link *link = link_for_conn(conn);
+    if (link == NULL) {
+        return;
+    }
+
+    /* None of these can be running: they share this queue */
+    k_work_cancel_delayable(&link->idle_work);
+    k_work_cancel_delayable(&link->request_work);
+    k_work_cancel_delayable(&link->retry_work);
+
+    LOG_DBG("Subrating link [%d]: %u procedures, %u coalesced, %u deferred",
+            (int)ARRAY_INDEX(links, link), link->procedures, link->coalesced, link->deferred);
+
+    bt_conn_unref(link->conn);
+    link->conn = NULL;
+}
+
+static void link_events_work_handler(struct k_work *work) {
+    struct link_event event;
+
+    while (k_msgq_get(&link_events, &event, K_NO_WAIT) == 0) {
+        if (event.connected) {
+            link_setup(event.conn);
+        } else {
+            link_teardown(event.conn);
+            bt_conn_unref(event.conn);
+        }
+    }
+}
+
+static void link_connected(struct bt_conn *conn, uint8_t err) {
+    struct bt_conn_info info;
+
+    if (err || bt_conn_get_info(conn, &info) || info.role != BT_CONN_ROLE_CENTRAL) {
+        return;
+    }
+
+    link_event_queue(conn, true);
+}
+
+static void link_disconnected(struct bt_conn *conn, uint8_t reason) {
+    struct bt_conn_info info;
+
+    if (bt_conn_get_info(conn, &info) || info.role != BT_CONN_ROLE_CENTRAL) {
+        return;
+    }
+
+    link_event_queue(conn, false);
+}
+
+static void link_param_updated(struct bt_conn *conn, uint16_t interval, uint16_t latency,
+                               uint16_t timeout) {
+    struct subrate_link *link = link_for_conn(conn);
+    if (link != NULL) {
+        link->interval_us = interval * 1250;
+    }
+}
+
+static void link_subrate_changed(struct bt_conn *conn,
+                                 const struct bt_conn_le_subrate_changed *params) {
+    struct subrate_link *link = link_for_conn(conn);
+    if (link == NULL) {
+        return;
+    }
+
+    bool solicited = link->request_in_flight;
+    struct bt_conn_le_subrate_param current;
+
+    link_tier_params(link, link->pos.tier, &current);
+
+    const struct bt_conn_le_subrate_param *expected = solicited ? &link->requested : &current;
+
+    k_work_cancel_delayable(&link->request_work);
+    link->request_in_flight = false;
+
+    switch (params->status) {
+    case BT_HCI_ERR_SUCCESS:
+        link->effective = *params;
+        link->diverged = params->factor < expected->subrate_min ||
+                         params->factor > expected->subrate_max;
+
+        if (!link->diverged) {
+            link->retries = 0;
+            link->effective_tier = solicited ? link->requested_tier : link->pos.tier;
+        } else if (!solicited && link->pos.tier != TIER_ACTIVE &&
+                   params->factor < expected->subrate_min) {
+            /* The peripheral sped the link up for its own activity */
+            subrate_ladder_enter(&link->pos, TIER_ACTIVE, k_uptime_get());
+            link->effective_tier = TIER_ACTIVE;
+            link->diverged = false;
+            link_schedule(link);
+        } else {
+            LOG_WRN("Subrating [%d]: factor %d outside requested %d-%d",
+                    (int)ARRAY_INDEX(links, link), params->factor, expected->subrate_min,
+                    expected->subrate_max);
+            link_retry(link);
+        }
+        break;
+    case BT_HCI_ERR_UNSUPP_REMOTE_FEATURE:
+        LOG_WRN("Subrating [%d]: not supported by peer", (int)ARRAY_INDEX(links, link));
+        link->unsupported = true;
+        break;
+    case BT_HCI_ERR_INVALID_LL_PARAM:
+    case BT_HCI_ERR_UNSUPP_LL_PARAM_VAL:
+    case BT_HCI_ERR_INVALID_PARAM:
+        /* Ask for less next time */
+        link->relax = MIN(link->relax + 1, 8);
+        link_retry(link);
+        break;
+    default:
+        /* Collisions and other transient failures */
+        link_retry(link);
+        break;
+    }
+
+    link_request_send(link);
+}
+
+int zmk_sdc_subrating_link_info_get(uint8_t slot, struct zmk_sdc_subrate_link_info *info) {
+    if (slot >= ARRAY_SIZE(links) || links[slot].conn == NULL) {
+        return -ENOTCONN;
+    }
+
+    const struct subrate_link *link = &links[slot];
+
+    *info = (struct zmk_sdc_subrate_link_info){
+        .tier = link->pos.tier,
+        .requested_min = link->requested.subrate_min,
+        .requested_max = link->requested.subrate_max,
+        .requested_cn = link->requested.continuation_number,
+        .factor = link->effective.factor,
+        .continuation_number = link->effective.continuation_number,
+        .peripheral_latency = link->effective.peripheral_latency,
+        .supervision_timeout = link->effective.supervision_timeout,
+        .diverged = link->diverged,
+        .unsupported = link->unsupported,
+        .retries = link->retries,
+    };
+
+    return 0;
+}
+
+BT_CONN_CB_DEFINE(subrating_link_cb) = {
+    .connected = link_connected,
+    .disconnected = link_disconnected,
+    .le_param_updated = link_param_updated,
+    .subrate_changed = link_subrate_changed,
+};
+
+/* Runtime tier parameters */
+
+static int tier_params_validate(const struct bt_conn_le_subrate_param *params) {
+    uint32_t span = params->subrate_max * (params->max_latency + 1);
+
+    if (params->subrate_min < 1 || params->subrate_max > 500 ||
+        params->subrate_max < params->subrate_min) {
+        return -EINVAL;
+    }
+
+    if (span > 500 || params->continuation_number >= params->subrate_max) {
+        return -EINVAL;
+    }
+
+    if (params->supervision_timeout < 10 || params->supervision_timeout > 3200 ||
+        params->supervision_timeout * 2 <= 3 * span) {
+        return -EINVAL;
+    }
+
+    return 0;
+}
+
+static void tier_params_changed(uint8_t tier) {
+    /* Tuning starts over from the new continuation number */
+    cn_tune_reset(tier);
+
+    if (tier == TIER_ACTIVE) {
+        adaptive_reset();
+    }
+
+    if (tier == TIER_IDLE) {
+        bt_conn_le_subrate_set_defaults(tier_base(TIER_IDLE));
+    }
+
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        if (links[i].conn && links[i].pos.tier == tier) {
+            link_request(&links[i]);
+        }
+    }
+}
+
+#if IS_ENABLED(CONFIG_SETTINGS)
+static void tier_save_work_handler(struct k_work *work) {
+    char name[40];
+
+    for (int i = 0; i < TIER_COUNT; i++) {
+        snprintf(name, sizeof(name), "subrate/%s", tiers[i].name);
+
+        int err = tier_customized[i]
+                      ? settings_save_one(name, &tier_custom[i], sizeof(tier_custom[i]))
+                      : settings_delete(name);
+        if (err) {
+            LOG_WRN("Failed to store subrating tier %s: %d", tiers[i].name, err);
+        }
+    }
+}
+
+static K_WORK_DELAYABLE_DEFINE(tier_save_work, tier_save_work_handler);
+
+static void tier_save(void) {
+    k_work_reschedule(&tier_save_work, K_MSEC(CONFIG_ZMK_SETTINGS_SAVE_DEBOUNCE));
+}
+
+static int tier_settings_set(const char *name, size_t len, settings_read_cb read_cb,
+                             void *cb_arg) {
+    struct bt_conn_le_subrate_param params;
+    const char *next;
+    int tier = 0;
+
+    while (tier < TIER_COUNT && !(settings_name_steq(name, tiers[tier].name, &next) && !next)) {
+        tier++;
+    }
+
+    if (tier == TIER_COUNT) {
+        return -ENOENT;
+    }
+
+    if (len != sizeof(params) || read_cb(cb_arg, &params, sizeof(params)) != sizeof(params)) {
+        return -EINVAL;
+    }
+
+    /* Rules may have tightened since the value was stored */
+    if (tier_params_validate(&params)) {
+        LOG_WRN("Ignoring stored subrating tier %s", tiers[tier].name);
+        return 0;
+    }
+
+    tier_custom[tier] = params;
+    tier_customized[tier] = true;
+
+    return 0;
+}
+
+static int tier_settings_commit(void) {
+    for (int i = 0; i < TIER_COUNT; i++) {
+        if (tier_customized[i]) {
+            tier_params_changed(i);
+        }
+    }
+
+    return 0;
+}
+
+SETTINGS_STATIC_HANDLER_DEFINE(subrate, "subrate", NULL, tier_settings_set,
+                               tier_settings_commit, NULL);
+#else
+static void tier_save(void) {}
+#endif /* CONFIG_SETTINGS */
+
+/* Changes from the API are applied on the system work queue, where the
+ * link handlers read the tier table; callers such as the shell only queue
+ * them. NULL params return the tier to its defaults.
+ */
+struct tier_update {
+    bool pending;
+    bool custom;
+    struct bt_conn_le_subrate_param params;
+};
+
+static struct tier_update tier_updates[TIER_COUNT];
+static struct k_spinlock tier_update_lock;
+
+static void tier_update_work_handler(struct k_work *work) {
+    for (int i = 0; i < TIER_COUNT; i++) {
+        struct tier_update update;
+
+        K_SPINLOCK(&tier_update_lock) {
+            update = tier_updates[i];
+            tier_updates[i].pending = false;
+        }
+
+        if (!update.pending || (!update.custom && !tier_customized[i])) {
+            continue;
+        }
+
+        if (update.custom) {
+            tier_custom[i] = update.params;
+            LOG_INF("Subrating tier %s set (factor=%d-%d, latency=%d, cn=%d, timeout=%d)",
+                    tiers[i].name, update.params.subrate_min, update.params.subrate_max,
+                    update.params.max_latency, update.params.continuation_number,
+                    update.params.supervision_timeout);
+        } else {
+            LOG_INF("Subrating tier %s reset to defaults", tiers[i].name);
+        }
+        tier_customized[i] = update.custom;
+
+        tier_params_changed(i);
+        tier_save();
+    }
+}
+
+static K_WORK_DEFINE(tier_update_work, tier_update_work_handler);
+
+static void tier_update_queue(uint8_t tier, const struct bt_conn_le_subrate_param *params) {
+    K_SPINLOCK(&tier_update_lock) {
+        tier_updates[tier].pending = true;
+        tier_updates[tier].custom = params != NULL;
+        if (params != NULL) {
+            tier_updates[tier].params = *params;
+        }
+    }
+
+    k_work_submit(&tier_update_work);
+}
+
+uint8_t zmk_sdc_subrating_tier_count(void) {
+    return TIER_COUNT;
+}
+
+int zmk_sdc_subrating_tier_get(uint8_t tier, struct bt_conn_le_subrate_param *params) {
+    if (tier >= TIER_COUNT) {
+        return -EINVAL;
+    }
+
+    *params = *tier_base(tier);
+
+    return 0;
+}
+
+int zmk_sdc_subrating_tier_set(uint8_t tier, const struct bt_conn_le_subrate_param *params) {
+    if (tier >= TIER_COUNT) {
+        return -EINVAL;
+    }
+
+    int err = tier_params_validate(params);
+    if (err) {
+        return err;
+    }
+
+    tier_update_queue(tier, params);
+
+    return 0;
+}
+
+int zmk_sdc_subrating_tier_reset(uint8_t tier) {
+    if (tier >= TIER_COUNT) {
+        return -EINVAL;
+    }
+
+    tier_update_queue(tier, NULL);
+
+    return 0;
+}
+
+#if IS_ENABLED(CONFIG_SHELL)
+static int tier_from_arg(const struct shell *sh, const char *arg) {
+    for (int i = 0; i < TIER_COUNT; i++) {
+        if (strcmp(arg, tiers[i].name) == 0) {
+            return i;
+        }
+    }
+
+    shell_error(sh, "Unknown tier %s", arg);
+    return -EINVAL;
+}
+
+static int cmd_subrate_show(const struct shell *sh, size_t argc, char **argv) {
+    for (int i = 0; i < TIER_COUNT; i++) {
+        const struct bt_conn_le_subrate_param *params = tier_params(i);
+
+        shell_print(sh, "%-8s factor=%d-%d latency=%d cn=%d timeout=%d%s", tiers[i].name,
+                    params->subrate_min, params->subrate_max, params->max_latency,
+                    params->continuation_number, params->supervision_timeout,
+                    tier_customized[i] ? " (custom)" : "");
+    }
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+    shell_print(sh, "Battery band: %s", bands[central_band].name);
+#endif
+
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        struct zmk_sdc_subrate_link_info info;
+
+        if (zmk_sdc_subrating_link_info_get(i, &info)) {
+            continue;
+        }
+
+        shell_print(sh, "Link %d: %s, requested %d-%d cn=%d, effective factor=%d cn=%d%s", i,
+                    tiers[info.tier].name, info.requested_min, info.requested_max,
+                    info.requested_cn, info.factor, info.continuation_number,
+                    info.unsupported ? " (unsupported)" : info.diverged ? " (diverged)" : "");
+    }
+
+    return 0;
+}
+
+static int cmd_subrate_set(const struct shell *sh, size_t argc, char **argv) {
+    int tier = tier_from_arg(sh, argv[1]);
+    if (tier < 0) {
+        return tier;
+    }
+
+    /* Range checked before narrowing to the uint16_t fields */
+    static const unsigned long limits[] = {500, 500, 499, 499, 3200};
+    unsigned long values[ARRAY_SIZE(limits)];
+    int err = 0;
+
+    values[4] = tier_base(tier)->supervision_timeout;
+    for (int i = 2; i < argc; i++) {
+        values[i - 2] = shell_strtoul(argv[i], 10, &err);
+        if (!err && values[i - 2] > limits[i - 2]) {
+            err = -ERANGE;
+        }
+        if (err) {
+            shell_error(sh, "Invalid number %s, at most %lu", argv[i], limits[i - 2]);
+            return err;
+        }
+    }
+
+    struct bt_conn_le_subrate_param params = {
+        .subrate_min = values[0],
+        .subrate_max = values[1],
+        .max_latency = values[2],
+        .continuation_number = values[3],
+        .supervision_timeout = values[4],
+    };
+
+    err = zmk_sdc_subrating_tier_set(tier, &params);
+    if (err) {
+        shell_error(sh, "Rejected: needs max >= min, max * (latency + 1) <= 500, cn < max "
+                        "and timeout * 2 > 3 * max * (latency + 1)");
+    }
+
+    return err;
+}
+
+static int cmd_subrate_reset(const struct shell *sh, size_t argc, char **argv) {
+    int tier = tier_from_arg(sh, argv[1]);
+    if (tier < 0) {
+        return tier;
+    }
+
+    return zmk_sdc_subrating_tier_reset(tier);
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_subrate,
+    SHELL_CMD(show, NULL, "Show tier parameters and split links", cmd_subrate_show),
+    SHELL_CMD_ARG(set, NULL, "Set tier parameters <tier> <min> <max> <latency> <cn> [timeout]",
+                  cmd_subrate_set, 6, 1),
+    SHELL_CMD_ARG(reset, NULL, "Reset tier parameters to their defaults <tier>",
+                  cmd_subrate_reset, 2, 0),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(subrate, &sub_subrate, "Connection subrating", NULL);
+#endif /* CONFIG_SHELL */
+
+static int zmk_sdc_subrating_init(void) {
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_BATTERY)
+    battery_ladders_init();
+#endif
+
+    for (int i = 0; i < ARRAY_SIZE(links); i++) {
+        k_work_init_delayable(&links[i].idle_work, link_idle_handler);
+        k_work_init_delayable(&links[i].request_work, link_request_work_handler);
+        k_work_init_delayable(&links[i].retry_work, link_retry_work_handler);
+    }
+
+    int err = bt_conn_le_subrate_set_defaults(tier_base(TIER_IDLE));
+    if (err) {
+        LOG_ERR("Failed to set subrating defaults: %d", err);
+        return err;
+    }
+
+#if IS_ENABLED(CONFIG_MPSL_PM_STATS)
+    mpsl_pm_stats_tag_set(activity.tier, tiers[activity.tier].name);
+#endif
+
+    for (int i = 0; i < TIER_COUNT; i++) {
+        LOG_INF("Subrating tier %d %s: factor=%d-%d/%d, after %us%s", i, tiers[i].name,
+                tiers[i].params->subrate_min, tiers[i].params->subrate_max,
+                tiers[i].params->max_latency, tier_entry_delay_ms[i] / 1000,
+                tiers[i].host ? ", host params" : "");
+    }
+
+    return 0;
+}
+
+SYS_INIT(zmk_sdc_subrating_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
+
+#endif /* CONFIG_ZMK_SPLIT_ROLE_CENTRAL */
+
+#if IS_ENABLED(CONFIG_ZMK_SPLIT) && !IS_ENABLED(CONFIG_ZMK_SPLIT_ROLE_CENTRAL)
+
+/*
+ * Peripheral half: request ACTIVE subrate when local activity is detected.
+ * This ensures the peripheral can send keystrokes quickly without waiting
+ * for the central to initiate a tier change.
+ */
+
+static const struct bt_conn_le_subrate_param peripheral_active_params = {
+    .subrate_min = 1,
+    .subrate_max = 2,
+    .max_latency = 0,
+    .continuation_number = 1,
+    .supervision_timeout = 400, /* 4 seconds */
+};
+
+static bool peripheral_is_active = false;
+
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_PERIPHERAL_FAST_WAKE)
+
+/*
+ * The subrate request only takes effect once its LL procedure completes,
+ * several subrated events later. Until then the SDC vendor peripheral
+ * latency mode keeps the peripheral listening in every connection event
+ * instead of skipping them, so neither the first key press nor the
+ * procedure waits out the peripheral latency of the slow tier.
+ */
+static bool latency_overridden;
+
+static void peripheral_latency_mode_set(struct bt_conn *conn, uint8_t mode) {
+    sdc_hci_cmd_vs_peripheral_latency_mode_set_t *cmd;
+    struct net_buf *buf;
+    uint16_t handle;
+
+    int err = bt_hci_get_conn_handle(conn, &handle);
+    if (err) {
+        LOG_WRN("No handle for peripheral latency mode: %d", err);
+        return;
+    }
+
+    buf = bt_hci_cmd_create(SDC_HCI_OPCODE_CMD_VS_PERIPHERAL_LATENCY_MODE_SET, sizeof(*cmd));
+    if (buf == NULL) {
+        LOG_WRN("No buffer for peripheral latency mode");
+        return;
+    }
+
+    cmd = net_buf_add(buf, sizeof(*cmd));
+    cmd->conn_handle = sys_cpu_to_le16(handle);
+    cmd->mode = mode;
+
+    /* Not waited for; listeners may run on the thread handling the reply */
+    err = bt_hci_cmd_send(SDC_HCI_OPCODE_CMD_VS_PERIPHERAL_LATENCY_MODE_SET, buf);
+    if (err) {
+        LOG_WRN("Failed to set peripheral latency mode: %d", err);
+    }
+}
+
+static void restore_latency_on_peripheral_conn(struct bt_conn *conn, void *data) {
+    struct bt_conn_info info;
+
+    bt_conn_get_info(conn, &info);
+
+    if (info.role == BT_CONN_ROLE_PERIPHERAL && info.state == BT_CONN_STATE_CONNECTED) {
+        peripheral_latency_mode_set(conn, SDC_HCI_VS_PERIPHERAL_LATENCY_MODE_ENABLE);
+    }
+}
+
+static void peripheral_latency_restore(void) {
+    if (latency_overridden) {
+        latency_overridden = false;
+        bt_conn_foreach(BT_CONN_TYPE_LE, restore_latency_on_peripheral_conn, NULL);
+    }
+}
+
+static void peripheral_fast_wake_subrate_changed(struct bt_conn *conn,
+                                                 const struct bt_conn_le_subrate_changed *params) {
+    /* The procedure that ended the slow tier has completed; the central
+     * may have accepted other parameters than requested, so the factor
+     * is not checked.
+     */
+    if (params->status == BT_HCI_ERR_SUCCESS) {
+        peripheral_latency_restore();
+    }
+}
+
+static void peripheral_fast_wake_disconnected(struct bt_conn *conn, uint8_t reason) {
+    struct bt_conn_info info;
+
+    /* The mode does not outlive the connection */
+    if (!bt_conn_get_info(conn, &info) && info.role == BT_CONN_ROLE_PERIPHERAL) {
+        latency_overridden = false;
+    }
+}
+
+BT_CONN_CB_DEFINE(peripheral_fast_wake_cb) = {
+    .disconnected = peripheral_fast_wake_disconnected,
+    .subrate_changed = peripheral_fast_wake_subrate_changed,
+};
+
+#endif /* CONFIG_ZMK_BLE_SUBRATE_PERIPHERAL_FAST_WAKE */
+
+static void apply_subrate_to_peripheral_conn(struct bt_conn *conn, void *data) {
+    const struct bt_conn_le_subrate_param *params = data;
+    struct bt_conn_info info;
+
+    bt_conn_get_info(conn, &info);
+
+    if (info.role == BT_CONN_ROLE_PERIPHERAL && info.state == BT_CONN_STATE_CONNECTED) {
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_PERIPHERAL_FAST_WAKE)
+        peripheral_latency_mode_set(conn, SDC_HCI_VS_PERIPHERAL_LATENCY_MODE_DISABLE);
+        latency_overridden = true;
+#endif
+
+        int err = bt_conn_le_subrate_request(conn, params);
+        if (err && err != -EALREADY) {
+            LOG_WRN("Peripheral failed to request subrate: %d", err);
+        }
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_PERIPHERAL_FAST_WAKE)
+        if (err) {
+            /* No procedure, so no subrate_changed to end the override */
+            peripheral_latency_restore();
+        }
+#endif
+    }
+}
+
+static int peripheral_subrating_activity_listener(const zmk_event_t *eh) {
+    struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev == NULL) {
+        return -ENOTSUP;
+    }
+
+    if (ev->state == ZMK_ACTIVITY_ACTIVE) {
+        if (!peripheral_is_active) {
+            LOG_INF("Peripheral requesting ACTIVE subrate");
+            bt_conn_foreach(BT_CONN_TYPE_LE, apply_subrate_to_peripheral_conn,
+                            (void *)&peripheral_active_params);
+            peripheral_is_active = true;
+        }
+    } else {
+        peripheral_is_active = false;
+#if IS_ENABLED(CONFIG_ZMK_BLE_SUBRATE_PERIPHERAL_FAST_WAKE)
+        /* The subrate procedure never completed */
+        peripheral_latency_restore();
+#endif
     }
 
     return 0;
@@ -0,0 +1,88 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include "subrating_ladder.h"
+
+static uint32_t step_delay_ms(const struct subrate_ladder *ladder, uint8_t to) {
+    uint32_t delay_ms = ladder->entry_delay_ms[to];
+
+    return delay_ms > ladder->min_dwell_ms ? delay_ms : ladder->min_dwell_ms;
+}
+
+void subrate_ladder_enter(struct subrate_ladder_pos *pos, uint8_t tier, int64_t now_ms) {
+    pos->tier = tier;
+    pos->since_ms = now_ms;
+}
+
+bool subrate_ladder_advance(const struct subrate_ladder *ladder, struct subrate_ladder_pos *pos,
+                            uint8_t floor, int64_t now_ms) {
+    uint8_t tier = pos->tier;
+    int64_t since_ms = pos->since_ms;
+
+    if (floor >= ladder->count) {
+        floor = ladder->count - 1;
+    }
+
+    /* A late timer skips the tiers it missed; each one counts as entered
+     * when it was due, so the following delays do not shift.
+     */
+    while (tier + 1 < ladder->count && now_ms - since_ms >= step_delay_ms(ladder, tier + 1)) {
+        since_ms += step_delay_ms(ladder, tier + 1);
+        tier++;
+    }
+
+    if (tier < floor && now_ms - pos->since_ms >= ladder->min_dwell_ms) {
+        tier = floor;
+        since_ms = now_ms;
+    }
+
+    if (tier == pos->tier) {
+        return false;
+    }
+
+    pos->tier = tier;
+    pos->since_ms = since_ms;
+
+    return true;
+}
+
+int64_t subrate_ladder_next_ms(const struct subrate_ladder *ladder,
+                               const struct subrate_ladder_pos *pos, uint8_t floor) {
+    if (pos->tier < floor && pos->tier + 1 < ladder->count) {
+        return pos->since_ms + ladder->min_dwell_ms;
+    }
+
+    if (pos->tier + 1 >= ladder->count) {
+        return SUBRATE_LADDER_NEVER;
+    }
+
+    return pos->since_ms + step_delay_ms(ladder, pos->tier + 1);
+}
+
+uint32_t subrate_budget_take(struct subrate_budget *budget, int64_t now_ms) {
+    if (budget->tokens >= budget->capacity) {
+        budget->refill_ms = now_ms;
+    } else {
+        int64_t refills = (now_ms - budget->refill_ms) / budget->refill_period_ms;
+        int64_t tokens = budget->tokens + refills;
+
+        budget->tokens = tokens < budget->capacity ? (uint8_t)tokens : budget->capacity;
+        budget->refill_ms += refills * budget->refill_period_ms;
+    }
+
+    if (budget->tokens == 0) {
+        return (uint32_t)(budget->refill_ms + budget->refill_period_ms - now_ms);
+    }
+
+    budget->tokens--;
+    return 0;
+}
+
+void subrate_budget_refund(struct subrate_budget *budget) {
+    if (budget->tokens < budget->capacity) {
+        budget->tokens++;
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#pragma once
+
+/*
+ * Subrating tier ladder: tier 0 is entered on activity, and each following
+ * tier after its entry delay in the one before it. Times are passed in, so
+ * the transitions do not depend on the kernel and run against any clock.
+ * The same holds for the procedure budget that paces the requests.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define SUBRATE_LADDER_NEVER INT64_MAX
+
+struct subrate_ladder {
+    /* Time in tier i - 1 before stepping down to tier i; [0] is unused */
+    const uint32_t *entry_delay_ms;
+    uint8_t count;
+    /* Shortest time in a tier before leaving it for a lower one */
+    uint32_t min_dwell_ms;
+};
+
+struct subrate_ladder_pos {
+    uint8_t tier;
+    int64_t since_ms;
+};
+
+/* Move to a tier, up or down, regardless of dwell */
+void subrate_ladder_enter(struct subrate_ladder_pos *pos, uint8_t tier, int64_t now_ms);
+
+/*
+ * Step down through every tier whose entry delay has passed, and at least
+ * to floor once the dwell allows. Never moves up. Returns true if the tier
+ * changed.
+ */
+bool subrate_ladder_advance(const struct subrate_ladder *ladder, struct subrate_ladder_pos *pos,
+                            uint8_t floor, int64_t now_ms);
+
+/* Time of the next step down, SUBRATE_LADDER_NEVER if there is none */
+int64_t subrate_ladder_next_ms(const struct subrate_ladder *ladder,
+                               const struct subrate_ladder_pos *pos, uint8_t floor);
+
+/*
+ * LL procedure budget: a token bucket holding up to capacity subrate or
+ * connection parameter procedures, refilled one token per refill period.
+ */
+struct subrate_budget {
+    uint8_t capacity;
+    uint32_t refill_period_ms;
+
+    uint8_t tokens;
+    int64_t refill_ms;
+};
+
+#define SUBRATE_BUDGET_INIT(_capacity, _refill_period_ms)                                         \
+    { .capacity = (_capacity), .refill_period_ms = (_refill_period_ms), .tokens = (_capacity) }
+
+/* Returns 0 if a procedure may start now, otherwise the ms to wait */
+uint32_t subrate_budget_take(struct subrate_budget *budget, int64_t now_ms);
+
+/* Give back the token of a procedure that could not be started */
+void subrate_budget_refund(struct subrate_budget *budget);
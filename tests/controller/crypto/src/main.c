@@ -0,0 +1,375 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#if defined(CONFIG_EXTERNAL_LIBC)
+#include <time.h>
+#endif
+
+#include <mpsl_ecb.h>
+
+#include "sdc_crypto.h"
+
+int bt_encrypt_le(const uint8_t key[16], const uint8_t plaintext[16], uint8_t enc_data[16]);
+int bt_encrypt_be(const uint8_t key[16], const uint8_t plaintext[16], uint8_t enc_data[16]);
+
+/* Software AES-128 standing in for the ECB peripheral */
+
+static uint8_t sbox[256];
+static uint32_t ecb_calls;
+
+static uint8_t xtime(uint8_t x)
+{
+	return (uint8_t)(x << 1) ^ ((x & 0x80) ? 0x1b : 0);
+}
+
+static uint8_t rotl8(uint8_t x, int shift)
+{
+	return (uint8_t)(x << shift) | (x >> (8 - shift));
+}
+
+static void sbox_init(void)
+{
+	uint8_t p = 1;
+	uint8_t q = 1;
+
+	/* p walks the multiplicative group by 3, q by its inverse 3^-1 */
+	do {
+		p = p ^ xtime(p);
+		q ^= q << 1;
+		q ^= q << 2;
+		q ^= q << 4;
+		if (q & 0x80) {
+			q ^= 0x09;
+		}
+		sbox[p] = q ^ rotl8(q, 1) ^ rotl8(q, 2) ^ rotl8(q, 3) ^ rotl8(q, 4) ^ 0x63;
+	} while (p != 1);
+
+	sbox[0] = 0x63;
+}
+
+static void aes128_encrypt(const uint8_t key[16], const uint8_t in[16], uint8_t out[16])
+{
+	uint8_t rk[176];
+	uint8_t s[16];
+	uint8_t rcon = 1;
+
+	memcpy(rk, key, 16);
+	for (int i = 16; i < 176; i += 4) {
+		uint8_t t[4] = {rk[i - 4], rk[i - 3], rk[i - 2], rk[i - 1]};
+
+		if (i % 16 == 0) {
+			uint8_t t0 = t[0];
+
+			t[0] = sbox[t[1]] ^ rcon;
+			t[1] = sbox[t[2]];
+			t[2] = sbox[t[3]];
+			t[3] = sbox[t0];
+			rcon = xtime(rcon);
+		}
+		for (int j = 0; j < 4; j++) {
+			rk[i + j] = rk[i - 16 + j] ^ t[j];
+		}
+	}
+
+	for (int i = 0; i < 16; i++) {
+		s[i] = in[i] ^ rk[i];
+	}
+
+	for (int round = 1; round <= 10; round++) {
+		uint8_t t[16];
+
+		/* SubBytes and ShiftRows; the state is column major */
+		for (int c = 0; c < 4; c++) {
+			for (int r = 0; r < 4; r++) {
+				t[c * 4 + r] = sbox[s[((c + r) % 4) * 4 + r]];
+			}
+		}
+
+		for (int c = 0; c < 4; c++) {
+			uint8_t *a = &t[c * 4];
+
+			if (round < 10) {
+				uint8_t all = a[0] ^ a[1] ^ a[2] ^ a[3];
+				uint8_t a0 = a[0];
+
+				a[0] ^= all ^ xtime(a[0] ^ a[1]);
+				a[1] ^= all ^ xtime(a[1] ^ a[2]);
+				a[2] ^= all ^ xtime(a[2] ^ a[3]);
+				a[3] ^= all ^ xtime(a[3] ^ a0);
+			}
+			for (int r = 0; r < 4; r++) {
+				s[c * 4 + r] = a[r] ^ rk[round * 16 + c * 4 + r];
+			}
+		}
+	}
+
+	memcpy(out, s, 16);
+}
+
+static void reverse(uint8_t *dst, const uint8_t *src, size_t len)
+{
+	for (size_t i = 0; i < len; i++) {
+		dst[i] = src[len - 1 - i];
+	}
+}
+
+void mpsl_ecb_block_encrypt_extended(const uint8_t key[16], const uint8_t cleartext[16],
+				     uint8_t ciphertext[16], uint32_t flags)
+{
+	uint8_t k[16];
+	uint8_t in[16];
+	uint8_t out[16];
+
+	if (flags & MPSL_ECB_INPUT_LE) {
+		reverse(k, key, 16);
+		reverse(in, cleartext, 16);
+	} else {
+		memcpy(k, key, 16);
+		memcpy(in, cleartext, 16);
+	}
+
+	aes128_encrypt(k, in, out);
+
+	if (flags & MPSL_ECB_OUTPUT_LE) {
+		reverse(ciphertext, out, 16);
+	} else {
+		memcpy(ciphertext, out, 16);
+	}
+
+	ecb_calls++;
+}
+
+int entropy_pool_get(uint8_t *buf, size_t len)
+{
+	memset(buf, 0, len);
+	return 0;
+}
+
+/* FIPS-197 Appendix C.1 */
+static const uint8_t fips_key[16] = {
+	0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
+	0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+};
+static const uint8_t fips_pt[16] = {
+	0x00, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66, 0x77,
+	0x88, 0x99, 0xaa, 0xbb, 0xcc, 0xdd, 0xee, 0xff,
+};
+static const uint8_t fips_ct[16] = {
+	0x69, 0xc4, 0xe0, 0xd8, 0x6a, 0x7b, 0x04, 0x30,
+	0xd8, 0xcd, 0xb7, 0x80, 0x70, 0xb4, 0xc5, 0x5a,
+};
+
+/* NIST SP 800-38A F.1.1, ECB-AES128 */
+static const uint8_t sp800_key[16] = {
+	0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+	0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c,
+};
+static const uint8_t sp800_pt[4][16] = {
+	{0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96,
+	 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a},
+	{0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c,
+	 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51},
+	{0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11,
+	 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef},
+	{0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17,
+	 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10},
+};
+static const uint8_t sp800_ct[4][16] = {
+	{0x3a, 0xd7, 0x7b, 0xb4, 0x0d, 0x7a, 0x36, 0x60,
+	 0xa8, 0x9e, 0xca, 0xf3, 0x24, 0x66, 0xef, 0x97},
+	{0xf5, 0xd3, 0xd5, 0x85, 0x03, 0xb9, 0x69, 0x9d,
+	 0xe7, 0x85, 0x89, 0x5a, 0x96, 0xfd, 0xba, 0xaf},
+	{0x43, 0xb1, 0xcd, 0x7f, 0x59, 0x8e, 0xce, 0x23,
+	 0x88, 0x1b, 0x00, 0xe3, 0xed, 0x03, 0x06, 0x88},
+	{0x7b, 0x0c, 0x78, 0x5e, 0x27, 0xe8, 0xad, 0x3f,
+	 0x82, 0x23, 0x20, 0x71, 0x04, 0x72, 0x5d, 0xd4},
+};
+
+/* Random address hash function ah, Core Specification Vol 3, Part H,
+ * Appendix D.7, in the little-endian order the host passes to
+ * bt_encrypt_le().
+ */
+static const uint8_t ah_irk_le[16] = {
+	0x9b, 0x7d, 0x39, 0x0a, 0xa6, 0x10, 0x10, 0x34,
+	0x05, 0xad, 0xc8, 0x57, 0xa3, 0x34, 0x02, 0xec,
+};
+static const uint8_t ah_prand_le[3] = {0x94, 0x81, 0x70};
+static const uint8_t ah_hash_le[3] = {0xaa, 0xfb, 0x0d};
+
+static void *crypto_setup(void)
+{
+	sbox_init();
+
+	return NULL;
+}
+
+static void crypto_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	ecb_calls = 0;
+}
+
+ZTEST(controller_crypto, test_be_batch_known_answers)
+{
+	uint8_t out[5][16];
+	struct sdc_crypto_ecb_block blocks[5] = {
+		{.key = fips_key, .plaintext = fips_pt, .enc_data = out[0]},
+	};
+
+	for (int i = 0; i < 4; i++) {
+		blocks[i + 1] = (struct sdc_crypto_ecb_block){
+			.key = sp800_key, .plaintext = sp800_pt[i], .enc_data = out[i + 1]};
+	}
+
+	sdc_crypto_encrypt_be_batch(blocks, ARRAY_SIZE(blocks));
+
+	zassert_equal(ecb_calls, ARRAY_SIZE(blocks));
+	zassert_mem_equal(out[0], fips_ct, 16);
+	for (int i = 0; i < 4; i++) {
+		zassert_mem_equal(out[i + 1], sp800_ct[i], 16, "block %d", i + 1);
+	}
+}
+
+ZTEST(controller_crypto, test_le_batch_known_answers)
+{
+	uint8_t key_le[16];
+	uint8_t pt_le[16];
+	uint8_t ct_le[16];
+	uint8_t ah_pt[16] = {0};
+	uint8_t out[2][16];
+
+	reverse(key_le, fips_key, 16);
+	reverse(pt_le, fips_pt, 16);
+	reverse(ct_le, fips_ct, 16);
+	memcpy(ah_pt, ah_prand_le, sizeof(ah_prand_le));
+
+	const struct sdc_crypto_ecb_block blocks[] = {
+		{.key = key_le, .plaintext = pt_le, .enc_data = out[0]},
+		{.key = ah_irk_le, .plaintext = ah_pt, .enc_data = out[1]},
+	};
+
+	sdc_crypto_encrypt_le_batch(blocks, ARRAY_SIZE(blocks));
+
+	zassert_mem_equal(out[0], ct_le, 16);
+	zassert_mem_equal(out[1], ah_hash_le, sizeof(ah_hash_le));
+}
+
+/* Same output as the single block calls, also when encrypting in place */
+ZTEST(controller_crypto, test_batch_matches_single)
+{
+	uint8_t keys[8][16];
+	uint8_t data[8][16];
+	uint8_t le[8][16];
+	uint8_t be[8][16];
+	struct sdc_crypto_ecb_block le_blocks[8];
+	struct sdc_crypto_ecb_block be_blocks[8];
+
+	for (int i = 0; i < 8; i++) {
+		for (int j = 0; j < 16; j++) {
+			keys[i][j] = (uint8_t)(i * 37 + j * 11);
+			data[i][j] = (uint8_t)(i * 53 + j * 7 + 1);
+		}
+		bt_encrypt_le(keys[i], data[i], le[i]);
+		bt_encrypt_be(keys[i], data[i], be[i]);
+	}
+
+	for (int i = 0; i < 8; i++) {
+		le_blocks[i] = (struct sdc_crypto_ecb_block){
+			.key = keys[i], .plaintext = data[i], .enc_data = data[i]};
+	}
+
+	uint8_t copy[8][16];
+
+	memcpy(copy, data, sizeof(copy));
+	for (int i = 0; i < 8; i++) {
+		be_blocks[i] = (struct sdc_crypto_ecb_block){
+			.key = keys[i], .plaintext = copy[i], .enc_data = copy[i]};
+	}
+
+	sdc_crypto_encrypt_le_batch(le_blocks, ARRAY_SIZE(le_blocks));
+	sdc_crypto_encrypt_be_batch(be_blocks, ARRAY_SIZE(be_blocks));
+
+	for (int i = 0; i < 8; i++) {
+		zassert_mem_equal(data[i], le[i], 16, "le block %d", i);
+		zassert_mem_equal(copy[i], be[i], 16, "be block %d", i);
+	}
+}
+
+ZTEST(controller_crypto, test_empty_batch)
+{
+	sdc_crypto_encrypt_le_batch(NULL, 0);
+	sdc_crypto_encrypt_be_batch(NULL, 0);
+
+	zassert_equal(ecb_calls, 0);
+}
+
+#define BENCH_IRKS   16
+#define BENCH_ROUNDS 2000
+
+#if defined(CONFIG_EXTERNAL_LIBC)
+static uint64_t host_now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * NSEC_PER_SEC + ts.tv_nsec;
+}
+#endif
+
+/* One RPA resolution against BENCH_IRKS bonds per round, as the host does
+ * it with bt_encrypt_le() and as one batch. The software AES is the same
+ * for both, so the difference is the per call overhead.
+ */
+ZTEST(controller_crypto, test_throughput)
+{
+#if defined(CONFIG_EXTERNAL_LIBC)
+	static uint8_t irks[BENCH_IRKS][16];
+	static uint8_t single[BENCH_IRKS][16];
+	static uint8_t batched[BENCH_IRKS][16];
+	static struct sdc_crypto_ecb_block blocks[BENCH_IRKS];
+	uint8_t r[16] = {0};
+
+	memcpy(r, ah_prand_le, sizeof(ah_prand_le));
+	for (int i = 0; i < BENCH_IRKS; i++) {
+		memset(irks[i], i + 1, 16);
+		blocks[i] = (struct sdc_crypto_ecb_block){
+			.key = irks[i], .plaintext = r, .enc_data = batched[i]};
+	}
+
+	uint64_t start_ns = host_now_ns();
+
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		for (int i = 0; i < BENCH_IRKS; i++) {
+			bt_encrypt_le(irks[i], r, single[i]);
+		}
+	}
+
+	uint64_t single_ns = host_now_ns() - start_ns;
+
+	start_ns = host_now_ns();
+	for (int round = 0; round < BENCH_ROUNDS; round++) {
+		sdc_crypto_encrypt_le_batch(blocks, BENCH_IRKS);
+	}
+
+	uint64_t batch_ns = host_now_ns() - start_ns;
+	uint64_t total = (uint64_t)BENCH_ROUNDS * BENCH_IRKS;
+
+	TC_PRINT("%llu blocks: bt_encrypt_le() %llu ns/block, batch %llu ns/block\n",
+		 (unsigned long long)total, (unsigned long long)(single_ns / total),
+		 (unsigned long long)(batch_ns / total));
+
+	zassert_equal(ecb_calls, 2 * total);
+	zassert_mem_equal(single, batched, sizeof(single));
+#else
+	ztest_test_skip();
+#endif
+}
+
+ZTEST_SUITE(controller_crypto, NULL, crypto_setup, crypto_before, NULL, NULL);
@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* The parts of nrfxlib's mpsl_ecb.h that crypto.c uses. The test provides
+ * a software AES-128 in place of the ECB peripheral.
+ */
+
+#ifndef MPSL_ECB_H__
+#define MPSL_ECB_H__
+
+#include <stdint.h>
+
+#define MPSL_ECB_NO_FLAGS  (0)
+#define MPSL_ECB_INPUT_LE  (1 << 0)
+#define MPSL_ECB_OUTPUT_LE (1 << 1)
+
+void mpsl_ecb_block_encrypt_extended(const uint8_t key[16], const uint8_t cleartext[16],
+				     uint8_t ciphertext[16], uint32_t flags);
+
+#endif /* MPSL_ECB_H__ */
@@ -0,0 +1,12 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* crypto.c includes nrfxlib's nrf_errno.h but uses none of it. */
+
+#ifndef NRF_ERRNO_H__
+#define NRF_ERRNO_H__
+
+#endif /* NRF_ERRNO_H__ */
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <string.h>
+#include <zephyr/kernel.h>
+#include <zephyr/ztest.h>
+#include <zephyr/bluetooth/hci.h>
+#include <zephyr/sys/byteorder.h>
+#include <psa/crypto.h>
+
+#include "ecdh.h"
+
+/* P-256 sample data, Core Specification Vol 3, Part H, Appendix D.
+ * Private key A is the debug private key used by ecdh.c.
+ */
+static const uint8_t private_b_be[32] = {
+	0x55, 0x18, 0x8b, 0x3d, 0x32, 0xf6, 0xbb, 0x9a, 0x90, 0x0a, 0xfc, 0xfb, 0xee, 0xd4, 0xe7, 0x2a,
+	0x59, 0xcb, 0x9a, 0xc2, 0xf1, 0x9d, 0x7c, 0xfb, 0x6b, 0x4f, 0xdd, 0x49, 0xf4, 0x7f, 0xc5, 0xfd,
+};
+
+static const uint8_t public_b_x_be[32] = {
+	0x1e, 0xa1, 0xf0, 0xf0, 0x1f, 0xaf, 0x1d, 0x96, 0x09, 0x59, 0x22, 0x84, 0xf1, 0x9e, 0x4c, 0x00,
+	0x47, 0xb5, 0x8a, 0xfd, 0x86, 0x15, 0xa6, 0x9f, 0x55, 0x90, 0x77, 0xb2, 0x2f, 0xaa, 0xa1, 0x90,
+};
+
+static const uint8_t public_b_y_be[32] = {
+	0x4c, 0x55, 0xf3, 0x3e, 0x42, 0x9d, 0xad, 0x37, 0x73, 0x56, 0x70, 0x3a, 0x9a, 0xb8, 0x51, 0x60,
+	0x47, 0x2d, 0x11, 0x30, 0xe2, 0x8e, 0x36, 0x76, 0x5f, 0x89, 0xaf, 0xf9, 0x15, 0xb1, 0x21, 0x4a,
+};
+
+static const uint8_t dhkey_be[32] = {
+	0xec, 0x02, 0x34, 0xa3, 0x57, 0xc8, 0xad, 0x05, 0x34, 0x10, 0x10, 0xa6, 0x0a, 0x39, 0x7d, 0x9b,
+	0x99, 0x79, 0x6b, 0x13, 0xb4, 0xf8, 0x66, 0xf1, 0x86, 0x8d, 0x34, 0xf3, 0x73, 0xbf, 0xa6, 0x98,
+};
+
+K_THREAD_STACK_DEFINE(work_q_stack, 8192);
+struct k_work_q mpsl_work_q;
+
+static K_SEM_DEFINE(evt_sem, 0, 1);
+
+static uint8_t evt[BT_HCI_EVT_HDR_SIZE + sizeof(struct bt_hci_evt_le_meta_event) +
+		   sizeof(struct bt_hci_evt_le_p256_public_key_complete)];
+
+static void evt_signal(void)
+{
+	k_sem_give(&evt_sem);
+}
+
+static void *ecdh_setup(void)
+{
+	k_work_queue_start(&mpsl_work_q, work_q_stack, K_THREAD_STACK_SIZEOF(work_q_stack),
+			   K_PRIO_PREEMPT(1), NULL);
+	zassert_equal(ecdh_init(evt_signal), 0);
+
+	return NULL;
+}
+
+static void ecdh_before(void *fixture)
+{
+	sdc_hci_msg_type_t msg_type;
+
+	ARG_UNUSED(fixture);
+
+	k_sem_reset(&evt_sem);
+	(void)ecdh_msg_get(evt, &msg_type);
+	memset(evt, 0, sizeof(evt));
+}
+
+/* Wait for the event and return its LE meta subevent parameters. */
+static uint8_t *le_evt_wait(uint8_t subevent)
+{
+	const struct bt_hci_evt_hdr *hdr = (const void *)&evt[0];
+	const struct bt_hci_evt_le_meta_event *meta = (const void *)&evt[sizeof(*hdr)];
+	sdc_hci_msg_type_t msg_type;
+
+	zassert_equal(k_sem_take(&evt_sem, K_SECONDS(10)), 0, "no event signalled");
+	zassert_equal(ecdh_msg_get(evt, &msg_type), 0);
+	zassert_equal(msg_type, SDC_HCI_MSG_TYPE_EVT);
+	zassert_equal(hdr->evt, BT_HCI_EVT_LE_META_EVENT);
+	zassert_equal(meta->subevent, subevent);
+	zassert_equal(ecdh_msg_get(evt, &msg_type), -EAGAIN, "event delivered twice");
+
+	return &evt[sizeof(*hdr) + sizeof(*meta)];
+}
+
+static void public_b_hci_get(uint8_t *hci_pk)
+{
+	sys_memcpy_swap(&hci_pk[0], public_b_x_be, 32);
+	sys_memcpy_swap(&hci_pk[32], public_b_y_be, 32);
+}
+
+ZTEST(controller_ecdh, test_debug_dhkey)
+{
+	uint8_t remote_pk[BT_PUB_KEY_LEN];
+	uint8_t expected[BT_DH_KEY_LEN];
+	struct bt_hci_evt_le_generate_dhkey_complete *rsp;
+
+	public_b_hci_get(remote_pk);
+	sys_memcpy_swap(expected, dhkey_be, sizeof(expected));
+
+	zassert_equal(ecdh_cmd_le_generate_dhkey(remote_pk, BT_HCI_LE_KEY_TYPE_DEBUG),
+		      BT_HCI_ERR_SUCCESS);
+
+	rsp = (void *)le_evt_wait(BT_HCI_EVT_LE_GENERATE_DHKEY_COMPLETE);
+	zassert_equal(rsp->status, BT_HCI_ERR_SUCCESS);
+	zassert_mem_equal(rsp->dhkey, expected, sizeof(expected));
+}
+
+ZTEST(controller_ecdh, test_dhkey_invalid_point)
+{
+	uint8_t remote_pk[BT_PUB_KEY_LEN];
+	uint8_t all_ones[BT_DH_KEY_LEN];
+	struct bt_hci_evt_le_generate_dhkey_complete *rsp;
+
+	public_b_hci_get(remote_pk);
+	remote_pk[32] ^= 0x01;
+	memset(all_ones, 0xff, sizeof(all_ones));
+
+	zassert_equal(ecdh_cmd_le_generate_dhkey(remote_pk, BT_HCI_LE_KEY_TYPE_DEBUG),
+		      BT_HCI_ERR_SUCCESS);
+
+	rsp = (void *)le_evt_wait(BT_HCI_EVT_LE_GENERATE_DHKEY_COMPLETE);
+	zassert_equal(rsp->status, BT_HCI_ERR_INVALID_PARAM);
+	zassert_mem_equal(rsp->dhkey, all_ones, sizeof(all_ones));
+}
+
+ZTEST(controller_ecdh, test_invalid_key_type)
+{
+	uint8_t remote_pk[BT_PUB_KEY_LEN];
+
+	public_b_hci_get(remote_pk);
+
+	zassert_equal(ecdh_cmd_le_generate_dhkey(remote_pk, 0x02), BT_HCI_ERR_INVALID_PARAM);
+	zassert_equal(k_sem_take(&evt_sem, K_MSEC(100)), -EAGAIN);
+}
+
+ZTEST(controller_ecdh, test_busy_until_read)
+{
+	uint8_t remote_pk[BT_PUB_KEY_LEN];
+
+	public_b_hci_get(remote_pk);
+
+	zassert_equal(ecdh_cmd_le_generate_dhkey(remote_pk, BT_HCI_LE_KEY_TYPE_DEBUG),
+		      BT_HCI_ERR_SUCCESS);
+	zassert_equal(ecdh_cmd_le_read_local_p256_public_key(), BT_HCI_ERR_CMD_DISALLOWED);
+
+	(void)le_evt_wait(BT_HCI_EVT_LE_GENERATE_DHKEY_COMPLETE);
+
+	zassert_equal(ecdh_cmd_le_generate_dhkey(remote_pk, BT_HCI_LE_KEY_TYPE_DEBUG),
+		      BT_HCI_ERR_SUCCESS);
+	(void)le_evt_wait(BT_HCI_EVT_LE_GENERATE_DHKEY_COMPLETE);
+}
+
+/* The generated DHKey must match what the peer computes from the local
+ * public key with private key B.
+ */
+ZTEST(controller_ecdh, test_generated_key_agreement)
+{
+	psa_key_attributes_t attr = PSA_KEY_ATTRIBUTES_INIT;
+	struct bt_hci_evt_le_p256_public_key_complete *pk_rsp;
+	struct bt_hci_evt_le_generate_dhkey_complete *dh_rsp;
+	uint8_t local_pk_sec1[1 + BT_PUB_KEY_LEN];
+	uint8_t remote_pk[BT_PUB_KEY_LEN];
+	uint8_t peer_dhkey_be[BT_DH_KEY_LEN];
+	uint8_t expected[BT_DH_KEY_LEN];
+	psa_key_id_t key_b;
+	size_t len;
+
+	zassert_equal(ecdh_cmd_le_read_local_p256_public_key(), BT_HCI_ERR_SUCCESS);
+	pk_rsp = (void *)le_evt_wait(BT_HCI_EVT_LE_P256_PUBLIC_KEY_COMPLETE);
+	zassert_equal(pk_rsp->status, BT_HCI_ERR_SUCCESS);
+
+	local_pk_sec1[0] = 0x04;
+	sys_memcpy_swap(&local_pk_sec1[1], &pk_rsp->key[0], 32);
+	sys_memcpy_swap(&local_pk_sec1[33], &pk_rsp->key[32], 32);
+
+	psa_set_key_usage_flags(&attr, PSA_KEY_USAGE_DERIVE);
+	psa_set_key_algorithm(&attr, PSA_ALG_ECDH);
+	psa_set_key_type(&attr, PSA_KEY_TYPE_ECC_KEY_PAIR(PSA_ECC_FAMILY_SECP_R1));
+	psa_set_key_bits(&attr, 256);
+	zassert_equal(psa_import_key(&attr, private_b_be, sizeof(private_b_be), &key_b),
+		      PSA_SUCCESS);
+	zassert_equal(psa_raw_key_agreement(PSA_ALG_ECDH, key_b, local_pk_sec1,
+					    sizeof(local_pk_sec1), peer_dhkey_be,
+					    sizeof(peer_dhkey_be), &len),
+		      PSA_SUCCESS, "local public key is not on the curve");
+	(void)psa_destroy_key(key_b);
+	sys_memcpy_swap(expected, peer_dhkey_be, sizeof(expected));
+
+	public_b_hci_get(remote_pk);
+	zassert_equal(ecdh_cmd_le_generate_dhkey(remote_pk, BT_HCI_LE_KEY_TYPE_GENERATED),
+		      BT_HCI_ERR_SUCCESS);
+
+	dh_rsp = (void *)le_evt_wait(BT_HCI_EVT_LE_GENERATE_DHKEY_COMPLETE);
+	zassert_equal(dh_rsp->status, BT_HCI_ERR_SUCCESS);
+	zassert_mem_equal(dh_rsp->dhkey, expected, sizeof(expected));
+}
+
+ZTEST_SUITE(controller_ecdh, NULL, ecdh_setup, ecdh_before, NULL, NULL);
@@ -0,0 +1,18 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+/* The parts of nrfxlib's sdc_hci.h that ecdh.h uses. */
+
+#ifndef SDC_HCI_H__
+#define SDC_HCI_H__
+
+typedef enum {
+	SDC_HCI_MSG_TYPE_EVT = 0x04,
+	SDC_HCI_MSG_TYPE_DATA = 0x02,
+	SDC_HCI_MSG_TYPE_ISO = 0x05,
+} sdc_hci_msg_type_t;
+
+#endif /* SDC_HCI_H__ */
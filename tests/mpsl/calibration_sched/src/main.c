@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/ztest.h>
+
+#include "mpsl_calibration_sched.h"
+
+#define BASE_MS 1000
+#define MAX_MS 4000
+#define TEMP_DIFF 2
+#define STABLE_READINGS 4
+
+static struct mpsl_calibration_sched sched;
+
+static void sched_before(void *fixture)
+{
+	ARG_UNUSED(fixture);
+
+	sched = (struct mpsl_calibration_sched){
+		.base_ms = BASE_MS,
+		.max_ms = MAX_MS,
+		.temp_diff = TEMP_DIFF,
+		.stable_readings = STABLE_READINGS,
+	};
+	mpsl_calibration_sched_reset(&sched, 100);
+}
+
+ZTEST(mpsl_calibration_sched, test_stretch_while_stable)
+{
+	uint32_t expected[] = {
+		BASE_MS, BASE_MS, BASE_MS, 2 * BASE_MS,
+		2 * BASE_MS, 2 * BASE_MS, 2 * BASE_MS, MAX_MS,
+		MAX_MS, MAX_MS, MAX_MS, MAX_MS,
+	};
+
+	for (size_t i = 0; i < ARRAY_SIZE(expected); i++) {
+		zassert_equal(mpsl_calibration_sched_next(&sched, 100), expected[i],
+			      "Reading %zu", i);
+	}
+}
+
+ZTEST(mpsl_calibration_sched, test_base_while_moving)
+{
+	for (int32_t temp = 100; temp < 140; temp += TEMP_DIFF) {
+		zassert_equal(mpsl_calibration_sched_next(&sched, temp + TEMP_DIFF), BASE_MS);
+	}
+}
+
+ZTEST(mpsl_calibration_sched, test_reset_on_change)
+{
+	for (int i = 0; i < 3 * STABLE_READINGS; i++) {
+		(void)mpsl_calibration_sched_next(&sched, 100);
+	}
+
+	zassert_equal(mpsl_calibration_sched_next(&sched, 100), MAX_MS);
+	zassert_equal(mpsl_calibration_sched_next(&sched, 100 - TEMP_DIFF), BASE_MS);
+	/* The new reading is the reference, stability is counted afresh */
+	for (int i = 0; i < STABLE_READINGS - 1; i++) {
+		zassert_equal(mpsl_calibration_sched_next(&sched, 100 - TEMP_DIFF), BASE_MS);
+	}
+	zassert_equal(mpsl_calibration_sched_next(&sched, 100 - TEMP_DIFF), 2 * BASE_MS);
+}
+
+ZTEST(mpsl_calibration_sched, test_slow_drift)
+{
+	/* Below the threshold per reading, but not against the reference */
+	zassert_equal(mpsl_calibration_sched_next(&sched, 101), BASE_MS);
+	zassert_equal(mpsl_calibration_sched_next(&sched, 101), BASE_MS);
+	zassert_equal(mpsl_calibration_sched_next(&sched, 101), BASE_MS);
+	zassert_equal(mpsl_calibration_sched_next(&sched, 101), 2 * BASE_MS);
+	zassert_equal(mpsl_calibration_sched_next(&sched, 102), BASE_MS);
+}
+
+/* Die temperature at a time on the fake clock: constant for ten minutes,
+ * then warming by one degree a minute for five minutes, then constant.
+ */
+static int32_t model_temp(uint64_t now_ms)
+{
+	uint64_t min = now_ms / 60000;
+
+	if (min < 10) {
+		return 100;
+	} else if (min < 15) {
+		return 100 + (int32_t)(now_ms - 10 * 60000) * 4 / 60000;
+	}
+
+	return 120;
+}
+
+ZTEST(mpsl_calibration_sched, test_model_hour)
+{
+	uint64_t now_ms = 0;
+	uint32_t wakeups = 0;
+	uint32_t period_ms = BASE_MS;
+	int32_t last_temp = model_temp(0);
+
+	while (now_ms < 3600 * 1000) {
+		now_ms += period_ms;
+		wakeups++;
+
+		int32_t temp = model_temp(now_ms);
+
+		/* A change MPSL reacts to always returns to the base period */
+		period_ms = mpsl_calibration_sched_next(&sched, temp);
+		if (temp - last_temp >= TEMP_DIFF) {
+			zassert_equal(period_ms, BASE_MS, "At %llu ms", (unsigned long long)now_ms);
+		}
+		zassert_true(period_ms >= BASE_MS && period_ms <= MAX_MS);
+		last_temp = temp;
+	}
+
+	/* A fixed base period wakes 3600 times; stable stretches cut most */
+	zassert_true(wakeups < 3600 / 3, "%u wakeups", wakeups);
+	zassert_true(wakeups > 3600 * 1000 / MAX_MS, "%u wakeups", wakeups);
+}
+
+ZTEST_SUITE(mpsl_calibration_sched, NULL, NULL, sched_before, NULL, NULL);
@@ -0,0 +1,205 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/ztest.h>
+
+#include "flash_sync_sched.h"
+
+/* FLASH_SLOT_WRITE of the nRF flash driver */
+#define SLOT_US 7500
+/* nRF52840 word write time */
+#define WORD_US 41
+/* MPSL_TIMESLOT_EARLIEST_TIMEOUT_MAX_US */
+#define EARLIEST_TIMEOUT_US 128000
+
+/* Periodic radio events of @c event_us at the start of every interval. */
+struct radio {
+	uint32_t interval_us;
+	uint32_t event_us;
+};
+
+struct result {
+	uint32_t slots;
+	uint32_t blocked;
+	/* Radio events overlapped by high priority slots */
+	uint32_t missed;
+	uint32_t max_used_us;
+	uint64_t end_us;
+};
+
+/* Model of an earliest request at normal priority: the first gap between
+ * radio events that holds the whole slot, UINT64_MAX if there is none.
+ */
+static uint64_t gap_find(const struct radio *radio, uint64_t t, uint32_t len)
+{
+	if (radio->event_us + len > radio->interval_us) {
+		return UINT64_MAX;
+	}
+
+	uint64_t period = t - t % radio->interval_us;
+
+	if (t - period < radio->event_us) {
+		return period + radio->event_us;
+	}
+	if (t - period + len <= radio->interval_us) {
+		return t;
+	}
+
+	return period + radio->interval_us + radio->event_us;
+}
+
+static uint32_t events_overlapped(const struct radio *radio, uint64_t start, uint32_t len)
+{
+	uint32_t count = 0;
+	uint64_t first = start - start % radio->interval_us;
+
+	for (uint64_t ev = first; ev < start + len; ev += radio->interval_us) {
+		if (ev + radio->event_us > start) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
+/* Write @p words words the way the flash driver does, one slot at a time.
+ * A high priority request is modelled as winning against the link at once.
+ */
+static struct result simulate(const struct radio *radio, uint32_t words)
+{
+	struct flash_sync_sched sched;
+	struct result res = {0};
+	uint64_t t = 1000;
+
+	flash_sync_sched_start(&sched, SLOT_US);
+
+	while (words > 0) {
+		uint64_t start;
+
+		if (sched.high_prio) {
+			start = t;
+			res.missed += events_overlapped(radio, start, SLOT_US);
+		} else {
+			start = gap_find(radio, t, SLOT_US);
+			if (start == UINT64_MAX || start - t > EARLIEST_TIMEOUT_US) {
+				res.blocked++;
+				flash_sync_sched_blocked(&sched);
+				t += EARLIEST_TIMEOUT_US;
+				continue;
+			}
+		}
+
+		flash_sync_sched_granted(&sched);
+		res.slots++;
+
+		uint32_t now_us = 0;
+
+		for (uint32_t i = 1; words > 0; i++) {
+			now_us += WORD_US;
+			words--;
+			if (flash_sync_sched_time_limit(&sched, now_us, i)) {
+				break;
+			}
+		}
+
+		res.max_used_us = MAX(res.max_used_us, now_us);
+		t = start + SLOT_US;
+	}
+
+	res.end_us = t;
+
+	return res;
+}
+
+ZTEST(flash_sync_sched, test_time_limit_keeps_margin)
+{
+	const uint32_t chunks_us[] = {1, WORD_US, 85, 500, 3000, 7000};
+	struct flash_sync_sched sched;
+
+	flash_sync_sched_start(&sched, SLOT_US);
+
+	for (size_t c = 0; c < ARRAY_SIZE(chunks_us); c++) {
+		uint32_t now_us = 0;
+		uint32_t i = 0;
+
+		do {
+			now_us += chunks_us[c];
+			i++;
+		} while (!flash_sync_sched_time_limit(&sched, now_us, i));
+
+		zassert_true(now_us + FLASH_SYNC_SCHED_END_MARGIN_US <= SLOT_US,
+			     "chunk %u us overran the slot", chunks_us[c]);
+		zassert_true(now_us + chunks_us[c] + FLASH_SYNC_SCHED_END_MARGIN_US >= SLOT_US,
+			     "chunk %u us stopped early at %u us", chunks_us[c], now_us);
+	}
+}
+
+ZTEST(flash_sync_sched, test_time_limit_iteration_zero)
+{
+	struct flash_sync_sched sched;
+
+	flash_sync_sched_start(&sched, SLOT_US);
+
+	zassert_false(flash_sync_sched_time_limit(&sched, 0, 0));
+	zassert_true(flash_sync_sched_time_limit(&sched, SLOT_US, 0));
+}
+
+ZTEST(flash_sync_sched, test_priority_follows_outcome)
+{
+	struct flash_sync_sched sched;
+
+	flash_sync_sched_start(&sched, SLOT_US);
+	zassert_false(sched.high_prio);
+
+	flash_sync_sched_blocked(&sched);
+	zassert_true(sched.high_prio);
+
+	flash_sync_sched_granted(&sched);
+	zassert_false(sched.high_prio);
+
+	flash_sync_sched_blocked(&sched);
+	flash_sync_sched_start(&sched, SLOT_US);
+	zassert_false(sched.high_prio, "a new operation starts at normal priority");
+}
+
+/* A 4 kB write on the links a keyboard uses fits between connection
+ * events and never needs high priority.
+ */
+ZTEST(flash_sync_sched, test_keyboard_links_lose_no_events)
+{
+	const struct radio radios[] = {
+		{.interval_us = 15000, .event_us = 2500},
+		{.interval_us = 30000, .event_us = 2500},
+		{.interval_us = 11250, .event_us = 2500},
+	};
+
+	for (size_t r = 0; r < ARRAY_SIZE(radios); r++) {
+		struct result res = simulate(&radios[r], 1024);
+
+		zassert_equal(res.blocked, 0, "interval %u us", radios[r].interval_us);
+		zassert_equal(res.missed, 0, "interval %u us", radios[r].interval_us);
+		zassert_true(res.max_used_us + FLASH_SYNC_SCHED_END_MARGIN_US <= SLOT_US);
+		zassert_equal(res.slots, DIV_ROUND_UP(1024, (SLOT_US - FLASH_SYNC_SCHED_END_MARGIN_US) /
+								   WORD_US),
+			      "interval %u us: %u slots", radios[r].interval_us, res.slots);
+	}
+}
+
+/* With no gap long enough for a slot every slot is taken at high
+ * priority after one blocked request, at the cost of the events it covers.
+ */
+ZTEST(flash_sync_sched, test_busy_link_escalates)
+{
+	const struct radio radio = {.interval_us = 7500, .event_us = 2500};
+	struct result res = simulate(&radio, 1024);
+
+	zassert_equal(res.blocked, res.slots);
+	zassert_true(res.missed <= 2 * res.slots, "%u events missed in %u slots", res.missed,
+		     res.slots);
+	zassert_true(res.end_us <= res.slots * (uint64_t)(EARLIEST_TIMEOUT_US + SLOT_US) + 1000);
+}
+
+ZTEST_SUITE(flash_sync_sched, NULL, NULL, NULL, NULL, NULL);
@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/ztest.h>
+
+#include "subrating_ladder.h"
+
+/* Kconfig defaults of the split link ladder and the procedure budget */
+#define LINK_IDLE_TIMEOUT_MS 10000
+#define DORMANT_DELAY_MS     900000
+#define MIN_DWELL_MS         5000
+#define PROCEDURES_PER_MIN   6
+#define PROCEDURE_REFILL_MS  (60000 / PROCEDURES_PER_MIN)
+
+/* Request to LL_SUBRATE_IND, a few subrated connection events */
+#define PROCEDURE_MS 200
+
+#define TRACE_MS       (15 * 60 * 1000)
+/* Long enough after the last press for the link to go dormant */
+#define SIM_MS         (TRACE_MS + LINK_IDLE_TIMEOUT_MS + DORMANT_DELAY_MS + 60000)
+#define MAX_PRESSES    8192
+#define MAX_PROCEDURES 1024
+
+static uint32_t entry_delay_ms[] = {0, LINK_IDLE_TIMEOUT_MS, DORMANT_DELAY_MS};
+
+static struct subrate_ladder ladder = {
+    .entry_delay_ms = entry_delay_ms,
+    .count = ARRAY_SIZE(entry_delay_ms),
+    .min_dwell_ms = MIN_DWELL_MS,
+};
+
+struct trace {
+    int64_t press_ms[MAX_PRESSES];
+    size_t count;
+};
+
+/*
+ * Link side of subrating.c: key presses enter tier 0, the ladder steps
+ * down, and each tier change asks for a procedure. Requests made while
+ * one is in flight, or step-downs over budget, are coalesced into the
+ * next one.
+ */
+struct sim {
+    bool budgeted;
+    struct subrate_budget budget;
+    struct subrate_ladder_pos pos;
+
+    bool pending;
+    bool in_flight;
+    int64_t done_ms;
+    int64_t wait_until_ms;
+    uint8_t requested_tier;
+
+    /* Key press that found the link slow, -1 if none waits */
+    int64_t wake_ms;
+
+    /* Starts of step-down procedures, the ones the budget is charged for */
+    int64_t down_ms[MAX_PROCEDURES];
+    uint32_t downs;
+    uint32_t procedures;
+    uint32_t deferred;
+    uint32_t wakes;
+    int64_t max_wake_ms;
+    int64_t total_wake_ms;
+};
+
+static struct trace trace;
+static struct sim before;
+static struct sim after;
+
+static uint32_t rand_state;
+
+static uint32_t rand_between(uint32_t lo, uint32_t hi) {
+    rand_state = rand_state * 1103515245 + 12345;
+    return lo + (rand_state >> 8) % (hi - lo + 1);
+}
+
+static void trace_press(int64_t now_ms) {
+    if (trace.count < MAX_PRESSES && now_ms < TRACE_MS) {
+        trace.press_ms[trace.count++] = now_ms;
+    }
+}
+
+/* Running text: words, sentence pauses and now and then a longer think */
+static void trace_prose(uint32_t seed) {
+    int64_t now = 1000;
+
+    rand_state = seed;
+    trace.count = 0;
+
+    while (now < TRACE_MS) {
+        uint32_t words = rand_between(5, 20);
+
+        for (uint32_t w = 0; w < words; w++) {
+            uint32_t keys = rand_between(2, 9);
+
+            for (uint32_t k = 0; k < keys; k++) {
+                trace_press(now);
+                now += rand_between(90, 280);
+            }
+            now += rand_between(150, 600);
+        }
+
+        now += rand_between(1, 10) == 1 ? rand_between(8000, 40000) : rand_between(800, 4000);
+    }
+}
+
+/* Chat: short messages, then reading the replies */
+static void trace_chat(uint32_t seed) {
+    int64_t now = 1000;
+
+    rand_state = seed;
+    trace.count = 0;
+
+    while (now < TRACE_MS) {
+        uint32_t keys = rand_between(8, 60);
+
+        for (uint32_t k = 0; k < keys; k++) {
+            trace_press(now);
+            now += rand_between(80, 350);
+        }
+
+        now += rand_between(4000, 45000);
+    }
+}
+
+/* Reading with a shortcut now and then: the most tier changes per key */
+static void trace_shortcuts(uint32_t seed, uint32_t gap_min_ms, uint32_t gap_max_ms) {
+    int64_t now = 1000;
+
+    rand_state = seed;
+    trace.count = 0;
+
+    while (now < TRACE_MS) {
+        uint32_t keys = rand_between(1, 3);
+
+        for (uint32_t k = 0; k < keys; k++) {
+            trace_press(now);
+            now += rand_between(60, 200);
+        }
+
+        now += rand_between(gap_min_ms, gap_max_ms);
+    }
+}
+
+static void sim_send(struct sim *sim, int64_t now) {
+    if (!sim->pending || sim->in_flight) {
+        return;
+    }
+
+    /* Step-downs wait for the budget, wake ups go out at once */
+    if (sim->budgeted && sim->pos.tier != 0) {
+        if (now < sim->wait_until_ms) {
+            return;
+        }
+
+        uint32_t wait_ms = subrate_budget_take(&sim->budget, now);
+
+        if (wait_ms) {
+            sim->deferred++;
+            sim->wait_until_ms = now + wait_ms;
+            return;
+        }
+    }
+
+    sim->pending = false;
+    sim->requested_tier = sim->pos.tier;
+    sim->in_flight = true;
+    sim->done_ms = now + PROCEDURE_MS;
+    if (sim->pos.tier != 0) {
+        if (sim->downs < MAX_PROCEDURES) {
+            sim->down_ms[sim->downs] = now;
+        }
+        sim->downs++;
+    }
+    sim->procedures++;
+}
+
+static void sim_request(struct sim *sim, int64_t now) {
+    sim->pending = true;
+    sim_send(sim, now);
+}
+
+static void sim_run(struct sim *sim, bool budgeted) {
+    size_t next = 0;
+
+    *sim = (struct sim){
+        .budgeted = budgeted,
+        .budget = SUBRATE_BUDGET_INIT(PROCEDURES_PER_MIN, PROCEDURE_REFILL_MS),
+        .wake_ms = -1,
+    };
+    subrate_ladder_enter(&sim->pos, 0, 0);
+    sim_request(sim, 0);
+
+    for (int64_t now = 0; now < SIM_MS; now++) {
+        if (sim->in_flight && now >= sim->done_ms) {
+            sim->in_flight = false;
+
+            if (sim->requested_tier == 0 && sim->wake_ms >= 0) {
+                int64_t wake_ms = now - sim->wake_ms;
+
+                sim->wakes++;
+                sim->total_wake_ms += wake_ms;
+                sim->max_wake_ms = MAX(sim->max_wake_ms, wake_ms);
+                sim->wake_ms = -1;
+            }
+        }
+
+        while (next < trace.count && trace.press_ms[next] <= now) {
+            next++;
+            if (sim->pos.tier != 0) {
+                if (sim->wake_ms < 0) {
+                    sim->wake_ms = now;
+                }
+                subrate_ladder_enter(&sim->pos, 0, now);
+                sim_request(sim, now);
+            } else {
+                subrate_ladder_enter(&sim->pos, 0, now);
+            }
+        }
+
+        if (subrate_ladder_advance(&ladder, &sim->pos, 0, now)) {
+            sim_request(sim, now);
+        }
+
+        sim_send(sim, now);
+    }
+}
+
+/* Most step-downs started in any minute */
+static uint32_t sim_peak_per_min(const struct sim *sim) {
+    uint32_t count = MIN(sim->downs, MAX_PROCEDURES);
+    uint32_t peak = 0;
+
+    for (uint32_t i = 0; i < count; i++) {
+        uint32_t in_window = 0;
+
+        for (uint32_t j = i; j < count && sim->down_ms[j] < sim->down_ms[i] + 60000; j++) {
+            in_window++;
+        }
+        peak = MAX(peak, in_window);
+    }
+
+    return peak;
+}
+
+static void sim_compare(const char *name) {
+    sim_run(&before, false);
+    sim_run(&after, true);
+
+    TC_PRINT("%s: %zu presses, procedures %u -> %u, step-downs peak %u -> %u per min, "
+             "%u deferred\n",
+             name, trace.count, before.procedures, after.procedures, sim_peak_per_min(&before),
+             sim_peak_per_min(&after), after.deferred);
+
+    zassert_true(after.downs <= MAX_PROCEDURES);
+    zassert_true(after.procedures <= before.procedures, "%s", name);
+    /* A full bucket, then one refill per period */
+    zassert_true(sim_peak_per_min(&after) <= 2 * PROCEDURES_PER_MIN, "%s: peak %u", name,
+                 sim_peak_per_min(&after));
+    zassert_true(after.downs <= PROCEDURES_PER_MIN + SIM_MS / PROCEDURE_REFILL_MS, "%s", name);
+    /* Key presses are never held back by the budget. A wake up only waits
+     * for a step-down that is already in flight, as it does without it.
+     */
+    zassert_equal(after.wakes, before.wakes, "%s", name);
+    zassert_true(after.max_wake_ms <= 2 * PROCEDURE_MS, "%s: wake up took %lld ms", name,
+                 (long long)after.max_wake_ms);
+    /* Deferred requests are coalesced, never lost */
+    zassert_false(after.pending, "%s", name);
+    zassert_equal(after.requested_tier, after.pos.tier, "%s", name);
+    zassert_equal(after.pos.tier, ladder.count - 1, "%s", name);
+    zassert_true(after.wake_ms < 0, "%s: a wake up was never requested", name);
+}
+
+static void budget_before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    entry_delay_ms[1] = LINK_IDLE_TIMEOUT_MS;
+    ladder.min_dwell_ms = MIN_DWELL_MS;
+}
+
+ZTEST(subrating_budget, test_take_until_empty) {
+    struct subrate_budget budget = SUBRATE_BUDGET_INIT(3, 1000);
+
+    for (int i = 0; i < 3; i++) {
+        zassert_equal(subrate_budget_take(&budget, 5000), 0);
+    }
+
+    zassert_equal(subrate_budget_take(&budget, 5000), 1000);
+    zassert_equal(subrate_budget_take(&budget, 5400), 600);
+    zassert_equal(subrate_budget_take(&budget, 6000), 0);
+    zassert_equal(subrate_budget_take(&budget, 6000), 1000);
+}
+
+ZTEST(subrating_budget, test_refill_caps_at_capacity) {
+    struct subrate_budget budget = SUBRATE_BUDGET_INIT(3, 1000);
+
+    zassert_equal(subrate_budget_take(&budget, 0), 0);
+    zassert_equal(subrate_budget_take(&budget, 0), 0);
+
+    /* Long idle refills to capacity and no further */
+    zassert_equal(subrate_budget_take(&budget, 60000), 0);
+    zassert_equal(subrate_budget_take(&budget, 60000), 0);
+    zassert_equal(subrate_budget_take(&budget, 60000), 0);
+    zassert_equal(subrate_budget_take(&budget, 60000), 1000);
+}
+
+ZTEST(subrating_budget, test_refill_keeps_phase) {
+    struct subrate_budget budget = SUBRATE_BUDGET_INIT(1, 1000);
+
+    zassert_equal(subrate_budget_take(&budget, 0), 0);
+    /* A take late in the period does not push the next refill back */
+    zassert_equal(subrate_budget_take(&budget, 1900), 0);
+    zassert_equal(subrate_budget_take(&budget, 1950), 50);
+}
+
+ZTEST(subrating_budget, test_refund) {
+    struct subrate_budget budget = SUBRATE_BUDGET_INIT(2, 1000);
+
+    zassert_equal(subrate_budget_take(&budget, 0), 0);
+    zassert_equal(subrate_budget_take(&budget, 0), 0);
+    subrate_budget_refund(&budget);
+    zassert_equal(subrate_budget_take(&budget, 0), 0);
+    zassert_equal(subrate_budget_take(&budget, 0), 1000);
+
+    subrate_budget_refund(&budget);
+    subrate_budget_refund(&budget);
+    subrate_budget_refund(&budget);
+    zassert_equal(budget.tokens, 2, "refunds stop at capacity");
+}
+
+/* Typing that pauses long enough to step down stays within budget */
+ZTEST(subrating_budget, test_prose) {
+    trace_prose(1);
+    sim_compare("prose");
+
+    zassert_equal(after.procedures, before.procedures);
+    zassert_equal(after.deferred, 0);
+}
+
+ZTEST(subrating_budget, test_chat) {
+    trace_chat(2);
+    sim_compare("chat");
+
+    zassert_equal(after.procedures, before.procedures);
+    zassert_equal(after.deferred, 0);
+}
+
+/* A step-down per shortcut, but the idle timeout keeps them within budget */
+ZTEST(subrating_budget, test_shortcuts) {
+    trace_shortcuts(3, 11000, 20000);
+    sim_compare("shortcuts");
+
+    zassert_equal(after.procedures, before.procedures);
+    zassert_equal(after.deferred, 0);
+    zassert_equal(after.max_wake_ms, PROCEDURE_MS);
+}
+
+/* With a short idle timeout the step-downs outrun the budget: it defers
+ * them, while every wake up still goes out at once.
+ */
+ZTEST(subrating_budget, test_short_idle_timeout) {
+    entry_delay_ms[1] = 2000;
+    ladder.min_dwell_ms = 0;
+
+    trace_shortcuts(4, 3000, 6000);
+    sim_compare("short idle timeout");
+
+    zassert_true(sim_peak_per_min(&before) > 2 * PROCEDURES_PER_MIN);
+    zassert_true(after.deferred > 0);
+    zassert_true(after.procedures < before.procedures);
+}
+
+ZTEST_SUITE(subrating_budget, NULL, NULL, budget_before, NULL, NULL);
@@ -0,0 +1,158 @@
+/*
+ * Copyright (c) 2025-2026 carrefinho
+ *
+ * SPDX-License-Identifier: MIT
+ */
+
+#include <zephyr/ztest.h>
+
+#include "subrating_ladder.h"
+
+#define MIN_DWELL_MS 5000
+
+enum { ACTIVE, WARM, IDLE, DORMANT };
+
+/* A devicetree style ladder; WARM comes sooner than the dwell allows */
+static const uint32_t entry_delay_ms[] = {0, 2000, 10000, 3600000};
+
+static const struct subrate_ladder ladder = {
+    .entry_delay_ms = entry_delay_ms,
+    .count = ARRAY_SIZE(entry_delay_ms),
+    .min_dwell_ms = MIN_DWELL_MS,
+};
+
+/* Fake clock: tests move it, the ladder only ever sees it as an argument */
+static int64_t now_ms;
+static struct subrate_ladder_pos pos;
+
+static bool step(uint8_t floor) {
+    return subrate_ladder_advance(&ladder, &pos, floor, now_ms);
+}
+
+/* Run the clock the way the work queue would, timer by timer */
+static void run_until(int64_t end_ms, uint8_t floor) {
+    for (;;) {
+        int64_t next_ms = subrate_ladder_next_ms(&ladder, &pos, floor);
+
+        if (next_ms == SUBRATE_LADDER_NEVER || next_ms > end_ms) {
+            break;
+        }
+
+        now_ms = next_ms;
+        zassert_true(step(floor), "timer at %lld ms moved nothing", (long long)now_ms);
+    }
+
+    now_ms = end_ms;
+}
+
+static void ladder_before(void *fixture) {
+    ARG_UNUSED(fixture);
+
+    now_ms = 1000;
+    subrate_ladder_enter(&pos, ACTIVE, now_ms);
+}
+
+ZTEST(subrating_ladder, test_steps_after_entry_delays) {
+    int64_t start_ms = now_ms;
+
+    /* WARM waits for the dwell, not its shorter entry delay */
+    now_ms = start_ms + MIN_DWELL_MS - 1;
+    zassert_false(step(ACTIVE));
+    now_ms = start_ms + MIN_DWELL_MS;
+    zassert_true(step(ACTIVE));
+    zassert_equal(pos.tier, WARM);
+    zassert_equal(pos.since_ms, now_ms);
+
+    now_ms += 10000 - 1;
+    zassert_false(step(ACTIVE));
+    now_ms++;
+    zassert_true(step(ACTIVE));
+    zassert_equal(pos.tier, IDLE);
+
+    now_ms += 3600000;
+    zassert_true(step(ACTIVE));
+    zassert_equal(pos.tier, DORMANT);
+
+    zassert_equal(subrate_ladder_next_ms(&ladder, &pos, ACTIVE), SUBRATE_LADDER_NEVER);
+    now_ms += 24 * 3600000LL;
+    zassert_false(step(ACTIVE), "nothing below the last tier");
+}
+
+ZTEST(subrating_ladder, test_late_timer_keeps_schedule) {
+    int64_t start_ms = now_ms;
+
+    /* One wake up long after WARM and IDLE were due */
+    now_ms = start_ms + MIN_DWELL_MS + 10000 + 7000;
+    zassert_true(step(ACTIVE));
+    zassert_equal(pos.tier, IDLE);
+    zassert_equal(pos.since_ms, start_ms + MIN_DWELL_MS + 10000,
+                  "IDLE counts from when it was due");
+    zassert_equal(subrate_ladder_next_ms(&ladder, &pos, ACTIVE),
+                  start_ms + MIN_DWELL_MS + 10000 + 3600000);
+}
+
+ZTEST(subrating_ladder, test_timers_match_steps) {
+    int64_t start_ms = now_ms;
+
+    run_until(start_ms + 2 * 3600000, ACTIVE);
+
+    zassert_equal(pos.tier, DORMANT);
+    zassert_equal(pos.since_ms, start_ms + MIN_DWELL_MS + 10000 + 3600000);
+}
+
+ZTEST(subrating_ladder, test_activity_restarts) {
+    run_until(now_ms + 20000, ACTIVE);
+    zassert_equal(pos.tier, IDLE);
+
+    subrate_ladder_enter(&pos, ACTIVE, now_ms);
+    zassert_equal(subrate_ladder_next_ms(&ladder, &pos, ACTIVE), now_ms + MIN_DWELL_MS);
+
+    /* Presses every 3 s keep the link up */
+    for (int i = 0; i < 100; i++) {
+        run_until(now_ms + 3000, ACTIVE);
+        zassert_equal(pos.tier, ACTIVE);
+        subrate_ladder_enter(&pos, ACTIVE, now_ms);
+    }
+}
+
+ZTEST(subrating_ladder, test_floor_waits_for_dwell) {
+    int64_t start_ms = now_ms;
+
+    /* The keyboard went idle right after a press on this link */
+    now_ms = start_ms + 1000;
+    zassert_false(step(IDLE));
+    zassert_equal(subrate_ladder_next_ms(&ladder, &pos, IDLE), start_ms + MIN_DWELL_MS);
+
+    now_ms = start_ms + MIN_DWELL_MS;
+    zassert_true(step(IDLE));
+    zassert_equal(pos.tier, IDLE, "straight to the floor, skipping WARM");
+    zassert_equal(pos.since_ms, now_ms);
+}
+
+ZTEST(subrating_ladder, test_floor_never_raises) {
+    run_until(now_ms + 3600000 + 60000, ACTIVE);
+    zassert_equal(pos.tier, DORMANT);
+
+    now_ms += 60000;
+    zassert_false(step(WARM));
+    zassert_equal(pos.tier, DORMANT);
+
+    /* A floor past the last tier stops at the last tier */
+    subrate_ladder_enter(&pos, IDLE, now_ms);
+    now_ms += MIN_DWELL_MS;
+    zassert_true(step(10));
+    zassert_equal(pos.tier, DORMANT);
+}
+
+ZTEST(subrating_ladder, test_enter_any_tier) {
+    subrate_ladder_enter(&pos, DORMANT, now_ms);
+    zassert_equal(pos.tier, DORMANT);
+
+    /* Entering a tier, also a higher one, restarts its time */
+    now_ms += 100;
+    subrate_ladder_enter(&pos, WARM, now_ms);
+    zassert_equal(pos.tier, WARM);
+    zassert_equal(subrate_ladder_next_ms(&ladder, &pos, ACTIVE), now_ms + 10000);
+}
+
+ZTEST_SUITE(subrating_ladder, NULL, NULL, ladder_before, NULL, NULL);